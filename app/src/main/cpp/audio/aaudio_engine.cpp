@@ -2,7 +2,9 @@
 
 #include <aaudio/AAudio.h>
 #include <algorithm>
+#include <cstring>
 #include <dlfcn.h>
+#include <time.h>
 
 #include "../logging/logging.h"
 
@@ -46,6 +48,9 @@ bool AAudioEngine::open(int rate, int channelCount) {
     AAudioStreamBuilder_setChannelCount(builder, channelCount);
     AAudioStreamBuilder_setFormat(builder, AAUDIO_FORMAT_PCM_I16);
     AAudioStreamBuilder_setErrorCallback(builder, aaudioErrorCallback, this);
+    if (useDataCallback) {
+        AAudioStreamBuilder_setDataCallback(builder, dataCallback, this);
+    }
 
     if (AAudioStreamBuilder_openStream(builder, &stream) != AAUDIO_OK) {
         LOGE("[Native] AAudio open failed");
@@ -58,6 +63,14 @@ bool AAudioEngine::open(int rate, int channelCount) {
         burstFrames = 192;
     }
 
+    if (useDataCallback) {
+        // The ring already absorbs USB jitter; double buffering keeps the
+        // output side at the burst latency.
+        aaudio_result_t setFrames = AAudioStream_setBufferSizeInFrames(stream, burstFrames * 2);
+        LOGD("[Native] AAudio callback mode: burst=%d buffer=%d", burstFrames, setFrames);
+        return true;
+    }
+
     int32_t capacityFrames = AAudioStream_getBufferCapacityInFrames(stream);
     if (capacityFrames > 0) {
         int32_t targetFrames = std::max(burstFrames * 4, (capacityFrames * 3) / 4);
@@ -72,17 +85,19 @@ bool AAudioEngine::open(int rate, int channelCount) {
 }
 
 void AAudioEngine::start() {
+    interrupted.store(false);
     if (stream) AAudioStream_requestStart(stream);
 }
 
 void AAudioEngine::write(const uint8_t* data, size_t sizeBytes) {
-    if (!stream || sizeBytes < 4) return;
+    if (!stream || useDataCallback || sizeBytes < 4) return;
 
     int32_t totalFrames = static_cast<int32_t>(sizeBytes / 4);
     int32_t writtenFrames = 0;
     int timeoutStreak = 0;
 
-    while (writtenFrames < totalFrames) {
+    // Each blocking call is short; interrupt() only has to end the retries.
+    while (writtenFrames < totalFrames && !interrupted.load(std::memory_order_relaxed)) {
         const uint8_t* writePtr = data + (writtenFrames * 4);
         int32_t framesLeft = totalFrames - writtenFrames;
         int32_t maxWriteFrames = std::max<int32_t>(96, burstFrames * 2);
@@ -129,6 +144,38 @@ void AAudioEngine::close() {
 
 int AAudioEngine::getBurstFrames() { return burstFrames; }
 
+bool AAudioEngine::getTimestamp(int64_t* framePosition, int64_t* timeNanos) {
+    if (!stream || disconnected) return false;
+    // Fails with AAUDIO_ERROR_INVALID_STATE until the stream is running.
+    return AAudioStream_getTimestamp(stream, CLOCK_MONOTONIC, framePosition, timeNanos) ==
+           AAUDIO_OK;
+}
+
+int64_t AAudioEngine::getQueuedFrames() {
+    if (!stream || disconnected) return -1;
+    // In callback mode "written" counts what the callback rendered, so this
+    // is the stream's buffer in both modes.
+    int64_t queued = AAudioStream_getFramesWritten(stream) - AAudioStream_getFramesRead(stream);
+    return queued >= 0 ? queued : -1;
+}
+
+bool AAudioEngine::setPullSource(AudioPullSource* source) {
+    if (!useDataCallback) return false;
+    pullSource = source;
+    return true;
+}
+
+aaudio_data_callback_result_t AAudioEngine::dataCallback(AAudioStream* stream, void* userData,
+                                                         void* audioData, int32_t numFrames) {
+    AAudioEngine* engine = static_cast<AAudioEngine*>(userData);
+    if (engine->pullSource) {
+        engine->pullSource->render(audioData, static_cast<size_t>(numFrames));
+    } else {
+        memset(audioData, 0, static_cast<size_t>(numFrames) * 4);
+    }
+    return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
 // --- AAudio Input Engine ---
 
 bool AAudioInputEngine::open(int rate, int channelCount) {
@@ -167,6 +214,12 @@ size_t AAudioInputEngine::read(uint8_t* data, size_t sizeBytes) {
     return result * 4;  // Return bytes read
 }
 
+void AAudioInputEngine::interrupt() {
+    // Stopping the stream makes a pending AAudioStream_read() return. The
+    // caller keeps the stream open until its read loop has exited.
+    if (stream) AAudioStream_requestStop(stream);
+}
+
 void AAudioInputEngine::stop() {
     if (stream) AAudioStream_requestStop(stream);
 }
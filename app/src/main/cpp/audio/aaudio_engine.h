@@ -8,12 +8,24 @@
 #include "audio_common.h"
 
 // --- AAudio Output Engine ---
+// Push mode (default) writes with blocking AAudioStream_write(). Callback
+// mode installs a data callback that pulls from an AudioPullSource, so no
+// consumer thread sits between the ring and AAudio.
 class AAudioEngine : public AudioEngine {
     AAudioStream* stream = nullptr;
     int32_t burstFrames = 0;
     std::atomic<bool> disconnected{false};
+    std::atomic<bool> interrupted{false};
+    bool useDataCallback = false;
+    AudioPullSource* pullSource = nullptr;
+
+    static aaudio_data_callback_result_t dataCallback(AAudioStream* stream, void* userData,
+                                                      void* audioData, int32_t numFrames);
 
 public:
+    AAudioEngine() = default;
+    explicit AAudioEngine(bool dataCallbackMode) : useDataCallback(dataCallbackMode) {}
+
     bool isDisconnected() const { return disconnected.load(); }
     void setDisconnected();
 
@@ -23,6 +35,10 @@ public:
     void stop() override;
     void close() override;
     int getBurstFrames() override;
+    bool getTimestamp(int64_t* framePosition, int64_t* timeNanos) override;
+    int64_t getQueuedFrames() override;
+    bool setPullSource(AudioPullSource* source) override;
+    void interrupt() override { interrupted.store(true); }
 };
 
 // --- AAudio Input Engine ---
@@ -37,6 +53,7 @@ public:
     size_t read(uint8_t* data, size_t sizeBytes) override;
     void stop() override;
     void close() override;
+    void interrupt() override;
 };
 
 #endif  // AAUDIO_ENGINE_H
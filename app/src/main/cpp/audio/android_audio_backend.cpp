@@ -0,0 +1,29 @@
+#include "android_audio_backend.h"
+
+#include "../logging/logging.h"
+#include "aaudio_engine.h"
+#include "java_audio_track_engine.h"
+#include "opensl_engine.h"
+
+AudioEngine* AndroidAudioBackend::createOutput(int engineType) {
+    if (engineType == 1) {
+        LOGD("[Native] Using OpenSL ES Engine");
+        return new OpenSLEngine();
+    }
+    if (engineType == 2) {
+        LOGD("[Native] Using Legacy AudioTrack Engine");
+        return new JavaAudioTrackEngine();
+    }
+    if (engineType == 3) {
+        LOGD("[Native] Using AAudio Engine (data callback)");
+        return new AAudioEngine(true);
+    }
+    LOGD("[Native] Using AAudio Engine");
+    return new AAudioEngine();
+}
+
+AudioInputEngine* AndroidAudioBackend::createInput(int micSource) {
+    AAudioInputEngine* input = new AAudioInputEngine();
+    input->setInputPreset(micSource);
+    return input;
+}
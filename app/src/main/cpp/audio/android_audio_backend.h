@@ -0,0 +1,15 @@
+#ifndef ANDROID_AUDIO_BACKEND_H
+#define ANDROID_AUDIO_BACKEND_H
+
+#include "audio_common.h"
+
+// --- Android Audio Backend ---
+// AAudio (push or data callback), OpenSL ES and the Java AudioTrack for
+// output; AAudio for the mic path.
+class AndroidAudioBackend : public AudioBackend {
+public:
+    AudioEngine* createOutput(int engineType) override;
+    AudioInputEngine* createInput(int micSource) override;
+};
+
+#endif  // ANDROID_AUDIO_BACKEND_H
@@ -4,6 +4,16 @@
 #include <cstddef>
 #include <cstdint>
 
+// --- Pull Source (Callback Engines) ---
+// Supplies output frames from inside the engine's real-time callback.
+// render() must fill all `frames` (zero-filling any shortfall) without
+// blocking, and returns how many of them carried real audio.
+class AudioPullSource {
+public:
+    virtual ~AudioPullSource() = default;
+    virtual size_t render(void* data, size_t frames) = 0;
+};
+
 // --- Audio Output Engine Interface ---
 class AudioEngine {
 public:
@@ -14,6 +24,22 @@ public:
     virtual void stop() = 0;
     virtual void close() = 0;
     virtual int getBurstFrames() = 0;
+
+    // Frame position that was presented at `timeNanos` (CLOCK_MONOTONIC).
+    // Engines without presentation timestamps return false.
+    virtual bool getTimestamp(int64_t* framePosition, int64_t* timeNanos) { return false; }
+
+    // Frames accepted by the engine that have not been played yet, or -1
+    // when the engine cannot tell. Called from the thread that drives write().
+    virtual int64_t getQueuedFrames() { return -1; }
+
+    // Pull-mode engines take their audio from `source` (set before open())
+    // and ignore write(). Push-only engines return false.
+    virtual bool setPullSource(AudioPullSource* source) { return false; }
+
+    // Any thread: cut a blocked write() short for teardown. Later writes may
+    // drop data; only stop() and close() are expected afterwards.
+    virtual void interrupt() {}
 };
 
 // --- Audio Input Engine Interface (For Mic) ---
@@ -26,6 +52,22 @@ public:
     virtual void stop() = 0;
     virtual void close() = 0;
     virtual void setInputPreset(int preset) {}
+
+    // Any thread: cut a blocked read() short for teardown.
+    virtual void interrupt() {}
+};
+
+// --- Audio Backend ---
+// Creates the platform's engines for the bridge. The app installs the
+// Android one (AAudio/OpenSL/AudioTrack); host builds use the null engines.
+class AudioBackend {
+public:
+    virtual ~AudioBackend() = default;
+    // engineType as passed to bridgeTask: 0 AAudio, 1 OpenSL, 2 AudioTrack,
+    // 3 AAudio data callback. Never null.
+    virtual AudioEngine* createOutput(int engineType) = 0;
+    // Mic path input with the given preset, or nullptr when unsupported.
+    virtual AudioInputEngine* createInput(int micSource) { return nullptr; }
 };
 
 #endif  // AUDIO_COMMON_H
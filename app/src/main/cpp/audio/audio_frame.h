@@ -0,0 +1,33 @@
+#ifndef AUDIO_FRAME_H
+#define AUDIO_FRAME_H
+
+#include <cstdint>
+#include <type_traits>
+
+// --- Interleaved PCM Frame Types ---
+// One frame = one sample per channel. Frame size is a compile-time constant,
+// so buffers typed on a frame never need runtime alignment checks.
+
+// Packed little-endian 24-bit sample (S24_3LE).
+struct Int24 {
+    uint8_t bytes[3];
+};
+
+template <typename Sample, int Channels>
+struct AudioFrame {
+    using SampleType = Sample;
+    static constexpr int kChannels = Channels;
+
+    Sample samples[Channels];
+};
+
+using FrameS16Stereo = AudioFrame<int16_t, 2>;
+using FrameS24Stereo = AudioFrame<Int24, 2>;
+using FrameS32Stereo = AudioFrame<int32_t, 2>;
+using FrameFloatStereo = AudioFrame<float, 2>;
+
+static_assert(sizeof(FrameS16Stereo) == 4, "16-bit stereo frame must be 4 bytes");
+static_assert(sizeof(FrameS24Stereo) == 6, "packed 24-bit stereo frame must be 6 bytes");
+static_assert(std::is_trivially_copyable<FrameS16Stereo>::value, "frames are copied raw");
+
+#endif  // AUDIO_FRAME_H
@@ -1,90 +1,87 @@
 #include "java_audio_track_engine.h"
 
-#include "../logging/logging.h"
+#include <cstring>
 
-JNIEnv* JavaAudioTrackEngine::getEnv() {
-    if (!javaVM) return nullptr;
-    JNIEnv* env;
-    int status = javaVM->GetEnv((void**)&env, JNI_VERSION_1_6);
-    if (status == JNI_EDETACHED) {
-        if (javaVM->AttachCurrentThread(&env, nullptr) != 0) {
-            return nullptr;
-        }
-    }
-    return env;
-}
+#include "../logging/jni_callbacks.h"
+#include "../logging/logging.h"
 
 bool JavaAudioTrackEngine::open(int rate, int channelCount) {
-    JNIEnv* env = getEnv();
+    JNIEnv* env = attachedEnv();
     if (!env || !serviceObj) return false;
 
-    serviceClass = env->GetObjectClass(serviceObj);
-    midInit = env->GetMethodID(serviceClass, "initAudioTrack", "(II)I");
-    midStart = env->GetMethodID(serviceClass, "startAudioTrack", "()V");
-    midWrite = env->GetMethodID(serviceClass, "writeAudioTrack", "(Ljava/nio/ByteBuffer;I)V");
-    midStop = env->GetMethodID(serviceClass, "stopAudioTrack", "()V");
-    midRelease = env->GetMethodID(serviceClass, "releaseAudioTrack", "()V");
-
-    if (!midInit || !midStart || !midWrite || !midStop || !midRelease) {
+    const JniCallbacks& cb = jniCallbacks;
+    if (!cb.initAudioTrack || !cb.startAudioTrack || !cb.writeAudioTrack || !cb.stopAudioTrack ||
+        !cb.releaseAudioTrack) {
         LOGE("[Native] Failed to find AudioTrack methods");
-        env->DeleteLocalRef(serviceClass);
         return false;
     }
 
-    int success = env->CallIntMethod(serviceObj, midInit, rate, channelCount);
-    env->DeleteLocalRef(serviceClass);
+    int success = env->CallIntMethod(serviceObj, cb.initAudioTrack, rate, channelCount);
+    clearJniException(env);
 
     prepared = (success > 0);
+    frameBytes = static_cast<size_t>(channelCount) * sizeof(int16_t);
     return prepared;
 }
 
 void JavaAudioTrackEngine::start() {
-    JNIEnv* env = getEnv();
+    JNIEnv* env = attachedEnv();
     if (env && prepared && serviceObj) {
-        env->CallVoidMethod(serviceObj, midStart);
+        framesWritten = 0;
+        env->CallVoidMethod(serviceObj, jniCallbacks.startAudioTrack);
     }
 }
 
 void JavaAudioTrackEngine::write(const uint8_t* data, size_t sizeBytes) {
-    JNIEnv* env = getEnv();
+    JNIEnv* env = attachedEnv();
     if (!env || !prepared || !serviceObj || !data || sizeBytes == 0) return;
 
-    if (!directBuffer || directBufferPtr != data || directBufferCapacity < sizeBytes) {
+    if (!directBuffer || staging.size() < sizeBytes) {
         if (directBuffer) {
             env->DeleteGlobalRef(directBuffer);
             directBuffer = nullptr;
         }
 
-        jobject localBuffer = env->NewDirectByteBuffer((void*)data, sizeBytes);
+        staging.resize(sizeBytes);
+        jobject localBuffer = env->NewDirectByteBuffer(staging.data(), (jlong)staging.size());
         if (!localBuffer) return;
         directBuffer = env->NewGlobalRef(localBuffer);
         env->DeleteLocalRef(localBuffer);
         if (!directBuffer) return;
-        directBufferPtr = data;
-        directBufferCapacity = sizeBytes;
     }
 
-    env->CallVoidMethod(serviceObj, midWrite, directBuffer, (jint)sizeBytes);
+    memcpy(staging.data(), data, sizeBytes);
+    env->CallVoidMethod(serviceObj, jniCallbacks.writeAudioTrack, directBuffer, (jint)sizeBytes);
+    framesWritten += static_cast<uint32_t>(sizeBytes / frameBytes);
 }
 
 void JavaAudioTrackEngine::stop() {
-    JNIEnv* env = getEnv();
+    JNIEnv* env = attachedEnv();
     if (env && prepared && serviceObj) {
-        env->CallVoidMethod(serviceObj, midStop);
+        env->CallVoidMethod(serviceObj, jniCallbacks.stopAudioTrack);
     }
 }
 
 void JavaAudioTrackEngine::close() {
-    JNIEnv* env = getEnv();
+    JNIEnv* env = attachedEnv();
     if (env && directBuffer) {
         env->DeleteGlobalRef(directBuffer);
         directBuffer = nullptr;
-        directBufferPtr = nullptr;
-        directBufferCapacity = 0;
+        staging.clear();
     }
     if (env && prepared && serviceObj) {
-        env->CallVoidMethod(serviceObj, midRelease);
+        env->CallVoidMethod(serviceObj, jniCallbacks.releaseAudioTrack);
     }
 }
 
 int JavaAudioTrackEngine::getBurstFrames() { return 480; }  // 10ms typical
+
+int64_t JavaAudioTrackEngine::getQueuedFrames() {
+    JNIEnv* env = attachedEnv();
+    if (!env || !prepared || !serviceObj || !jniCallbacks.getAudioTrackHeadPosition) return -1;
+
+    jint head = env->CallIntMethod(serviceObj, jniCallbacks.getAudioTrackHeadPosition);
+    if (clearJniException(env)) return -1;
+    int32_t queued = static_cast<int32_t>(framesWritten - static_cast<uint32_t>(head));
+    return queued >= 0 ? queued : -1;
+}
@@ -3,22 +3,24 @@
 
 #include <jni.h>
 
+#include <cstdint>
+#include <vector>
+
 #include "audio_common.h"
 
+// Method IDs come from the JNI callback registry; the calling thread's
+// env is attached once and cached.
 class JavaAudioTrackEngine : public AudioEngine {
-    jclass serviceClass = nullptr;
-    jmethodID midInit = nullptr;
-    jmethodID midStart = nullptr;
-    jmethodID midWrite = nullptr;
-    jmethodID midStop = nullptr;
-    jmethodID midRelease = nullptr;
     bool prepared = false;
+    // Engine-owned staging memory wrapped once as a direct ByteBuffer, so
+    // callers can hand in any pointer (e.g. ring storage) without a new
+    // JNI buffer object per write.
     jobject directBuffer = nullptr;
-    const uint8_t* directBufferPtr = nullptr;
-    size_t directBufferCapacity = 0;
-
-    // Helper to get ENV for the current thread
-    JNIEnv* getEnv();
+    std::vector<uint8_t> staging;
+    // Frames handed to the track since start(); wraps like the track's
+    // 32-bit playback head position it is compared against.
+    uint32_t framesWritten = 0;
+    size_t frameBytes = 4;
 
 public:
     bool open(int rate, int channelCount) override;
@@ -27,6 +29,7 @@ public:
     void stop() override;
     void close() override;
     int getBurstFrames() override;
+    int64_t getQueuedFrames() override;
 };
 
 #endif  // JAVA_AUDIOTRACK_ENGINE_H
@@ -0,0 +1,80 @@
+#include "null_audio_engine.h"
+
+#include <algorithm>
+
+bool NullAudioEngine::open(int rate, int channelCount) {
+    rate_ = rate > 0 ? rate : 48000;
+    frameBytes_ = static_cast<size_t>(std::max(1, channelCount)) * sizeof(int16_t);
+    framesWritten_ = 0;
+    playedFrames_ = 0;
+    anchorFrames_ = 0;
+    return true;
+}
+
+void NullAudioEngine::start() {
+    interrupted_.store(false);
+    running_ = true;
+    anchorFrames_ = playedFrames_;
+    anchorTime_ = Clock::now();
+}
+
+void NullAudioEngine::advance(Clock::time_point now) {
+    if (!running_) return;
+    int64_t elapsedNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - anchorTime_).count();
+    int64_t position = anchorFrames_ + elapsedNs * rate_ / 1000000000LL;
+    if (position >= framesWritten_) {
+        // Starved: the device plays silence and resumes from here.
+        playedFrames_ = framesWritten_;
+        anchorFrames_ = framesWritten_;
+        anchorTime_ = now;
+    } else {
+        playedFrames_ = position;
+    }
+}
+
+void NullAudioEngine::write(const uint8_t* data, size_t sizeBytes) {
+    advance(Clock::now());
+    framesWritten_ += static_cast<int64_t>(sizeBytes / frameBytes_);
+    if (!paced_ || !running_) return;
+
+    while (framesWritten_ - playedFrames_ > bufferFrames_ && !interrupted_.load()) {
+        // When the play head reaches the frame that makes room again.
+        int64_t target = framesWritten_ - bufferFrames_ - anchorFrames_;
+        auto due = anchorTime_ + std::chrono::nanoseconds(target * 1000000000LL / rate_);
+        std::unique_lock<std::mutex> lock(waitMutex_);
+        waitCond_.wait_until(lock, due, [this] { return interrupted_.load(); });
+        lock.unlock();
+        advance(Clock::now());
+    }
+}
+
+void NullAudioEngine::stop() {
+    advance(Clock::now());
+    running_ = false;
+    // Like a real device, stopping drops whatever was still queued.
+    framesWritten_ = playedFrames_;
+}
+
+bool NullAudioEngine::getTimestamp(int64_t* framePosition, int64_t* timeNanos) {
+    if (!running_) return false;
+    auto now = Clock::now();
+    advance(now);
+    *framePosition = playedFrames_;
+    *timeNanos =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    return true;
+}
+
+int64_t NullAudioEngine::getQueuedFrames() {
+    advance(Clock::now());
+    return framesWritten_ - playedFrames_;
+}
+
+void NullAudioEngine::interrupt() {
+    {
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        interrupted_.store(true);
+    }
+    waitCond_.notify_all();
+}
@@ -0,0 +1,58 @@
+#ifndef NULL_AUDIO_ENGINE_H
+#define NULL_AUDIO_ENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "audio_common.h"
+
+// --- Null Output Engine ---
+// Discards everything. Unpaced, write() returns at once, so a benchmark
+// measures only the bridge's own CPU cost. Paced, it models a device with a
+// `bufferFrames` queue drained at the stream rate: write() blocks while the
+// queue is full and a starved device idles until new data arrives, which
+// keeps the bridge loop at real-time cadence on a workstation.
+class NullAudioEngine : public AudioEngine {
+public:
+    explicit NullAudioEngine(bool paced = false, int bufferFrames = 960)
+        : paced_(paced), bufferFrames_(bufferFrames) {}
+
+    bool open(int rate, int channelCount) override;
+    void start() override;
+    void write(const uint8_t* data, size_t sizeBytes) override;
+    void stop() override;
+    void close() override {}
+    int getBurstFrames() override { return kBurstFrames; }
+    bool getTimestamp(int64_t* framePosition, int64_t* timeNanos) override;
+    int64_t getQueuedFrames() override;
+    void interrupt() override;
+
+    int64_t framesWritten() const { return framesWritten_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int kBurstFrames = 192;
+
+    // Move the play head to `now`; re-anchors the clock when starved.
+    void advance(Clock::time_point now);
+
+    const bool paced_;
+    const int64_t bufferFrames_;
+    int rate_ = 48000;
+    size_t frameBytes_ = 4;
+    bool running_ = false;
+
+    int64_t framesWritten_ = 0;
+    int64_t playedFrames_ = 0;
+    int64_t anchorFrames_ = 0;
+    Clock::time_point anchorTime_;
+
+    std::atomic<bool> interrupted_{false};
+    std::mutex waitMutex_;
+    std::condition_variable waitCond_;
+};
+
+#endif  // NULL_AUDIO_ENGINE_H
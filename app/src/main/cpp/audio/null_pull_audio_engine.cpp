@@ -0,0 +1,83 @@
+#include "null_pull_audio_engine.h"
+
+#include <algorithm>
+
+bool NullPullAudioEngine::open(int rate, int channelCount) {
+    rate_ = rate > 0 ? rate : 48000;
+    frameBytes_ = static_cast<size_t>(std::max(1, channelCount)) * sizeof(int16_t);
+    buffer_.assign(static_cast<size_t>(burstFrames_) * frameBytes_, 0);
+    renderedFrames_ = 0;
+    dataFrames_ = 0;
+    return true;
+}
+
+bool NullPullAudioEngine::setPullSource(AudioPullSource* source) {
+    source_ = source;
+    return true;
+}
+
+void NullPullAudioEngine::start() {
+    if (thread_.joinable() || buffer_.empty()) return;
+    anchorTime_ = Clock::now();
+    anchorFrames_ = renderedFrames_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+    }
+    thread_ = std::thread(&NullPullAudioEngine::run, this);
+}
+
+void NullPullAudioEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void NullPullAudioEngine::run() {
+    const auto burst = std::chrono::nanoseconds(int64_t(burstFrames_) * 1000000000LL / rate_);
+    auto due = anchorTime_;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (cond_.wait_until(lock, due, [this] { return !running_; })) break;
+        }
+
+        size_t got = 0;
+        if (source_) {
+            got = source_->render(buffer_.data(), static_cast<size_t>(burstFrames_));
+        }
+        renderedFrames_.fetch_add(burstFrames_, std::memory_order_relaxed);
+        dataFrames_.fetch_add(static_cast<int64_t>(got), std::memory_order_relaxed);
+
+        due += burst;
+        // A thread descheduled for several bursts resumes on time instead of
+        // firing the missed callbacks back to back.
+        auto now = Clock::now();
+        if (now - due > 4 * burst) due = now;
+    }
+}
+
+int64_t NullPullAudioEngine::playedFrames(Clock::time_point now) const {
+    int64_t elapsedNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - anchorTime_).count();
+    // Each callback fills the burst that plays after the current one.
+    int64_t played = anchorFrames_ + elapsedNs * rate_ / 1000000000LL - burstFrames_;
+    return std::max(anchorFrames_, std::min(played, framesRendered()));
+}
+
+bool NullPullAudioEngine::getTimestamp(int64_t* framePosition, int64_t* timeNanos) {
+    if (!thread_.joinable()) return false;
+    auto now = Clock::now();
+    *framePosition = playedFrames(now);
+    *timeNanos =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    return true;
+}
+
+int64_t NullPullAudioEngine::getQueuedFrames() {
+    if (!thread_.joinable()) return 0;
+    return std::min<int64_t>(framesRendered() - playedFrames(Clock::now()), 2 * burstFrames_);
+}
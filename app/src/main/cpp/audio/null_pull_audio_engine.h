@@ -0,0 +1,67 @@
+#ifndef NULL_PULL_AUDIO_ENGINE_H
+#define NULL_PULL_AUDIO_ENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "audio_common.h"
+
+// --- Null Callback Engine ---
+// Host stand-in for the AAudio data callback (engine type 3). Between
+// start() and stop() its own thread calls the pull source's render() once
+// per burst on an absolute schedule at the stream rate and discards the
+// audio, so bridgeTask runs its pull-mode supervisor and RingPullSource
+// runs exactly as on the phone. Models the callback stream's two-burst
+// buffer for getQueuedFrames() and getTimestamp().
+class NullPullAudioEngine : public AudioEngine {
+public:
+    explicit NullPullAudioEngine(int burstFrames = 192) : burstFrames_(burstFrames) {}
+    ~NullPullAudioEngine() override { stop(); }
+
+    bool open(int rate, int channelCount) override;
+    void start() override;
+    void write(const uint8_t* data, size_t sizeBytes) override {}
+    void stop() override;
+    void close() override { stop(); }
+    int getBurstFrames() override { return burstFrames_; }
+    bool getTimestamp(int64_t* framePosition, int64_t* timeNanos) override;
+    int64_t getQueuedFrames() override;
+    bool setPullSource(AudioPullSource* source) override;
+
+    // Frames the callback asked for, and how many of them carried data.
+    // Readable from any thread.
+    int64_t framesRendered() const { return renderedFrames_.load(std::memory_order_relaxed); }
+    int64_t dataFrames() const { return dataFrames_.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void run();
+    // Frames the modelled device has played by `now`.
+    int64_t playedFrames(Clock::time_point now) const;
+
+    const int burstFrames_;
+    int rate_ = 48000;
+    size_t frameBytes_ = 4;
+    AudioPullSource* source_ = nullptr;
+    std::vector<uint8_t> buffer_;
+
+    // Set by start() before the thread exists.
+    Clock::time_point anchorTime_;
+    int64_t anchorFrames_ = 0;
+
+    std::thread thread_;
+    bool running_ = false;  // Guarded by mutex_
+    std::mutex mutex_;
+    std::condition_variable cond_;
+
+    std::atomic<int64_t> renderedFrames_{0};
+    std::atomic<int64_t> dataFrames_{0};
+};
+
+#endif  // NULL_PULL_AUDIO_ENGINE_H
@@ -1,14 +1,52 @@
 #include "opensl_engine.h"
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
 #include "../logging/logging.h"
 
 void OpenSLEngine::bqPlayerCallback(SLAndroidSimpleBufferQueueItf bq, void* context) {
     OpenSLEngine* engine = static_cast<OpenSLEngine*>(context);
-    std::lock_guard<std::mutex> lock(engine->queueMutex);
-    if (engine->availableSlots < kQueueDepth) {
-        engine->availableSlots++;
+    // Buffers complete in FIFO order, so this frees the oldest slot.
+    engine->completedCount.fetch_add(1, std::memory_order_seq_cst);
+    if (engine->slotWaiters.load(std::memory_order_seq_cst) != 0) {
+        syscall(SYS_futex, &engine->completedCount, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr,
+                nullptr, 0);
+    }
+}
+
+int32_t OpenSLEngine::pendingSlots(uint32_t completed) {
+    int32_t pending = static_cast<int32_t>(enqueuedCount - completed);
+    if (pending < 0) {
+        // A buffer cleared by stop() still got its callback; the queue is
+        // empty, so catch up with the player's count.
+        enqueuedCount = completed;
+        pending = 0;
     }
-    engine->queueCv.notify_one();
+    return pending;
+}
+
+// Wait up to ~60 ms for the player to release a slot.
+bool OpenSLEngine::waitForSlot() {
+    for (int i = 0; i < 3 && !interrupted.load(std::memory_order_relaxed); ++i) {
+        slotWaiters.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t completed = completedCount.load(std::memory_order_seq_cst);
+        if (pendingSlots(completed) < kQueueDepth) {
+            slotWaiters.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        struct timespec timeout = {0, 20000000};
+        syscall(SYS_futex, &completedCount, FUTEX_WAIT_PRIVATE, completed, &timeout, nullptr,
+                0);
+        slotWaiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return pendingSlots(completedCount.load(std::memory_order_acquire)) < kQueueDepth;
 }
 
 bool OpenSLEngine::open(int rate, int channelCount) {
@@ -65,56 +103,60 @@ bool OpenSLEngine::open(int rate, int channelCount) {
     result = (*playerBufferQueue)->RegisterCallback(playerBufferQueue, bqPlayerCallback, this);
     if (result != SL_RESULT_SUCCESS) return false;
 
+    slots.assign(kSlotBytes * kQueueDepth, 0);
+    frameBytes = static_cast<size_t>(channelCount) * sizeof(int16_t);
+    enqueuedCount = 0;
+    completedCount.store(0);
     return true;
 }
 
 void OpenSLEngine::start() {
+    interrupted.store(false);
     if (playerPlay) (*playerPlay)->SetPlayState(playerPlay, SL_PLAYSTATE_PLAYING);
 }
 
 void OpenSLEngine::write(const uint8_t* data, size_t sizeBytes) {
     if (!playerBufferQueue) return;
 
-    // Wait for a queue slot; do not enqueue blindly when the queue is full.
-    bool ready = false;
-    for (int i = 0; i < 3 && !ready; ++i) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        ready = queueCv.wait_for(lock, std::chrono::milliseconds(20),
-                                 [this] { return availableSlots > 0; });
-        if (ready) {
-            availableSlots--;
+    while (sizeBytes > 0) {
+        // Wait for a queue slot; do not enqueue blindly when the queue is full.
+        if (!waitForSlot()) {
+            static int waitTimeoutLogCount = 0;
+            if ((waitTimeoutLogCount++ % 50) == 0) {
+                LOGE("[Native] OpenSL queue wait timeout");
+            }
+            return;
         }
-    }
 
-    if (!ready) {
-        static int waitTimeoutLogCount = 0;
-        if ((waitTimeoutLogCount++ % 50) == 0) {
-            LOGE("[Native] OpenSL queue wait timeout");
-        }
-        return;
-    }
-
-    SLresult result = (*playerBufferQueue)->Enqueue(playerBufferQueue, data, sizeBytes);
-    if (result != SL_RESULT_SUCCESS) {
-        static int enqueueErrorLogCount = 0;
-        if ((enqueueErrorLogCount++ % 50) == 0) {
-            LOGE("[Native] OpenSL enqueue failed: %d", result);
-        }
-        std::lock_guard<std::mutex> lock(queueMutex);
-        if (availableSlots < kQueueDepth) {
-            availableSlots++;
+        // Copy once: the caller's buffer is reused as soon as we return.
+        uint32_t index = enqueuedCount % kQueueDepth;
+        uint8_t* slot = slots.data() + index * kSlotBytes;
+        size_t chunk = std::min(sizeBytes, kSlotBytes);
+        memcpy(slot, data, chunk);
+
+        SLresult result = (*playerBufferQueue)->Enqueue(playerBufferQueue, slot, chunk);
+        if (result != SL_RESULT_SUCCESS) {
+            static int enqueueErrorLogCount = 0;
+            if ((enqueueErrorLogCount++ % 50) == 0) {
+                LOGE("[Native] OpenSL enqueue failed: %d", result);
+            }
+            return;
         }
+        slotBytes[index] = chunk;
+        enqueuedCount++;
+        data += chunk;
+        sizeBytes -= chunk;
     }
 }
 
 void OpenSLEngine::stop() {
     if (playerPlay) (*playerPlay)->SetPlayState(playerPlay, SL_PLAYSTATE_STOPPED);
     if (playerBufferQueue) (*playerBufferQueue)->Clear(playerBufferQueue);
-    {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        availableSlots = kQueueDepth;
-    }
-    queueCv.notify_all();
+    // Cleared buffers never get a callback; hand all slots back from the
+    // writer's side. completedCount stays the callback's: one already in
+    // flight may still bump it past enqueuedCount, which pendingSlots()
+    // absorbs.
+    enqueuedCount = completedCount.load(std::memory_order_seq_cst);
 }
 
 void OpenSLEngine::close() {
@@ -132,4 +174,25 @@ void OpenSLEngine::close() {
     }
 }
 
+void OpenSLEngine::interrupt() {
+    interrupted.store(true, std::memory_order_relaxed);
+    // The waiter compares against completedCount, which is left alone; one
+    // that has not reached FUTEX_WAIT yet sleeps at most one 20 ms round.
+    syscall(SYS_futex, &completedCount, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
 int OpenSLEngine::getBurstFrames() { return 192; }  // Default approximate burst
+
+int64_t OpenSLEngine::getQueuedFrames() {
+    if (!playerBufferQueue) return -1;
+    // Slots between completed and enqueued are still in the player's queue.
+    // The callback may retire one concurrently; that only makes this a
+    // slight overestimate.
+    uint32_t completed = completedCount.load(std::memory_order_acquire);
+    int32_t pending = std::min(pendingSlots(completed), kQueueDepth);
+    size_t bytes = 0;
+    for (int32_t i = 0; i < pending; ++i) {
+        bytes += slotBytes[(completed + i) % kQueueDepth];
+    }
+    return static_cast<int64_t>(bytes / frameBytes);
+}
@@ -4,12 +4,16 @@
 #include <SLES/OpenSLES.h>
 #include <SLES/OpenSLES_Android.h>
 
-#include <condition_variable>
+#include <atomic>
 #include <cstdint>
-#include <mutex>
+#include <vector>
 
 #include "audio_common.h"
 
+// --- OpenSL ES Output Engine ---
+// The simple buffer queue keeps a pointer to each enqueued buffer until it
+// has been played, so the engine copies every write into one of its own
+// kQueueDepth slots instead of enqueuing the caller's (ring) memory.
 class OpenSLEngine : public AudioEngine {
     SLObjectItf engineObject = nullptr;
     SLEngineItf engineEngine = nullptr;
@@ -18,12 +22,29 @@ class OpenSLEngine : public AudioEngine {
     SLPlayItf playerPlay = nullptr;
     SLAndroidSimpleBufferQueueItf playerBufferQueue = nullptr;
 
-    std::mutex queueMutex;
-    std::condition_variable queueCv;
     static constexpr int kQueueDepth = 4;
-    int availableSlots = kQueueDepth;
+    // Larger than any bridge chunk; bigger writes span several slots.
+    static constexpr size_t kSlotBytes = 4096;
+    std::vector<uint8_t> slots;
+    // Bytes enqueued from each slot, for getQueuedFrames().
+    size_t slotBytes[kQueueDepth] = {};
+    size_t frameBytes = 4;
+
+    // Slot i % kQueueDepth is free while enqueuedCount - completedCount <
+    // kQueueDepth. Only the writer (write(), stop()) touches enqueuedCount
+    // and only the player callback advances completedCount, which doubles as
+    // a futex word. The difference is compared signed: a completion that
+    // lands after stop() resynced the counters reads as a free slot, and the
+    // writer catches up on its next write.
+    uint32_t enqueuedCount = 0;
+    std::atomic<uint32_t> completedCount{0};
+    std::atomic<uint32_t> slotWaiters{0};
+    std::atomic<bool> interrupted{false};
 
     static void bqPlayerCallback(SLAndroidSimpleBufferQueueItf bq, void* context);
+    // Buffers still in the player's queue as of `completed`; never negative.
+    int32_t pendingSlots(uint32_t completed);
+    bool waitForSlot();
 
 public:
     bool open(int rate, int channelCount) override;
@@ -32,6 +53,8 @@ public:
     void stop() override;
     void close() override;
     int getBurstFrames() override;
+    int64_t getQueuedFrames() override;
+    void interrupt() override;
 };
 
 #endif  // OPENSL_ENGINE_H
@@ -0,0 +1,140 @@
+#include "ring_buffer.h"
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+RingBufferBase::RingBufferBase(size_t capacity_frames, size_t frame_bytes, bool mirrored)
+    : size_(capacity_frames) {
+    size_t frames = 1;
+    while (frames < size_) frames <<= 1;
+
+    if (mirrored) {
+        // Both views must start on a page boundary: keep doubling until the
+        // storage is a whole number of pages (page size is a power of two).
+        long page = sysconf(_SC_PAGESIZE);
+        if (page > 0) {
+            while ((frames * frame_bytes) % static_cast<size_t>(page) != 0) frames <<= 1;
+        }
+        if (mapMirrored(frames * frame_bytes)) {
+            mask_ = frames - 1;
+            return;
+        }
+    }
+
+    storage_bytes_ = frames * frame_bytes;
+    buffer_.resize(storage_bytes_);
+    storage_ = buffer_.data();
+    mask_ = frames - 1;
+}
+
+RingBufferBase::~RingBufferBase() {
+    if (mirror_) {
+        munmap(mirror_, storage_bytes_ * 2);
+    }
+}
+
+bool RingBufferBase::mapMirrored(size_t storage_bytes) {
+    // memfd_create() is only in bionic from API 30; go through the syscall.
+    int fd = static_cast<int>(syscall(__NR_memfd_create, "usbaudio-ring", MFD_CLOEXEC));
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(storage_bytes)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // Reserve the whole window first so nothing else can land in between.
+    void* base = mmap(nullptr, storage_bytes * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    uint8_t* lower = static_cast<uint8_t*>(base);
+    uint8_t* upper = lower + storage_bytes;
+    bool mapped = mmap(lower, storage_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+                       0) != MAP_FAILED &&
+                  mmap(upper, storage_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+                       0) != MAP_FAILED;
+    // The mappings keep the pages alive.
+    close(fd);
+
+    if (!mapped) {
+        munmap(base, storage_bytes * 2);
+        return false;
+    }
+
+    mirror_ = lower;
+    storage_ = lower;
+    storage_bytes_ = storage_bytes;
+    return true;
+}
+
+void RingBufferBase::wake(WaitSignal& signal) {
+    signal.sequence.fetch_add(1, std::memory_order_seq_cst);
+    syscall(SYS_futex, &signal.sequence, FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+template <typename Ready>
+bool RingBufferBase::waitOn(WaitSignal& signal, Ready ready, std::chrono::microseconds timeout) {
+    if (ready()) return true;
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        // Register first, then re-check: either we see the new index or the
+        // other side sees us and bumps the sequence before we sleep on it.
+        signal.waiters.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t sequence = signal.sequence.load(std::memory_order_seq_cst);
+        if (ready()) {
+            signal.waiters.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        // Checked after registering, like ready(), so interruptWaits()
+        // either is seen here or bumps the sequence we are about to sleep on.
+        if (interrupted_.load(std::memory_order_seq_cst)) {
+            signal.waiters.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            signal.waiters.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(remaining.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(remaining.count() % 1000000000);
+        syscall(SYS_futex, &signal.sequence, FUTEX_WAIT_PRIVATE, sequence, &ts, nullptr, 0);
+        signal.waiters.fetch_sub(1, std::memory_order_relaxed);
+
+        if (ready()) return true;
+    }
+}
+
+bool RingBufferBase::waitForReadable(size_t frames, std::chrono::microseconds timeout) {
+    return waitOn(
+        readable_,
+        [this, frames] {
+            return head_.load(std::memory_order_seq_cst) -
+                       tail_.load(std::memory_order_relaxed) >= frames;
+        },
+        timeout);
+}
+
+bool RingBufferBase::waitForWritable(size_t frames, std::chrono::microseconds timeout) {
+    return waitOn(
+        writable_,
+        [this, frames] {
+            return size_ - (head_.load(std::memory_order_relaxed) -
+                            tail_.load(std::memory_order_seq_cst)) >= frames;
+        },
+        timeout);
+}
@@ -3,70 +3,235 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <vector>
 
+#include "audio_frame.h"
+
 // --- Lock-Free Ring Buffer (SPSC) ---
 // Single Producer (Capture), Single Consumer (Bridge)
-class RingBuffer {
+//
+// RingBufferBase owns storage, indices and blocking waits. All counts are in
+// frames, so it never needs to know the frame layout; RingBuffer<Frame> adds
+// the typed views on top with sizeof(Frame) fixed at compile time.
+class RingBufferBase {
 public:
-    RingBuffer(size_t size_bytes) : size_(size_bytes), head_(0), tail_(0) { buffer_.resize(size_); }
+    RingBufferBase(const RingBufferBase&) = delete;
+    RingBufferBase& operator=(const RingBufferBase&) = delete;
+
+    // Producer: publish `count` frames previously reserved by beginWrite().
+    void commitWrite(size_t count) {
+        // seq_cst pairs with the waiter registration in waitForReadable() so
+        // a sleeping consumer cannot miss this commit.
+        head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_seq_cst);
+        if (readable_.waiters.load(std::memory_order_seq_cst) != 0) {
+            wake(readable_);
+        }
+    }
 
-    size_t write(const uint8_t* data, size_t count) {
-        size_t current_tail = tail_.load(std::memory_order_acquire);
-        size_t available = size_ - (head_.load(std::memory_order_relaxed) - current_tail);
-        // Avoid all-or-nothing drops under transient jitter.
-        // Keep sample/frame alignment (16-bit stereo = 4 bytes/frame).
-        size_t to_write = std::min(count, available);
-        to_write -= (to_write % 4);
-        if (to_write == 0) return 0;
+    // Consumer: release `count` frames previously reserved by beginRead().
+    void commitRead(size_t count) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_seq_cst);
+        if (writable_.waiters.load(std::memory_order_seq_cst) != 0) {
+            wake(writable_);
+        }
+    }
+
+    // Consumer: block until at least `frames` are readable. Returns false on
+    // timeout. The producer only issues a futex wake while someone waits.
+    bool waitForReadable(size_t frames, std::chrono::microseconds timeout);
+
+    // Producer: block until at least `frames` can be written. Returns false
+    // on timeout.
+    bool waitForWritable(size_t frames, std::chrono::microseconds timeout);
+
+    // Any thread: make current and future waits return false at once. For
+    // teardown only; a ring is not reused after it has been interrupted.
+    void interruptWaits() {
+        interrupted_.store(true, std::memory_order_seq_cst);
+        wake(readable_);
+        wake(writable_);
+    }
+
+    // Readable frames.
+    size_t available() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    }
 
-        size_t write_idx = head_.load(std::memory_order_relaxed) % size_;
-        size_t first_chunk = std::min(to_write, size_ - write_idx);
+    // Usable capacity in frames.
+    size_t capacity() const {
+        return size_;
+    }
 
-        memcpy(&buffer_[write_idx], data, first_chunk);
-        if (first_chunk < to_write) {
-            memcpy(&buffer_[0], data + first_chunk, to_write - first_chunk);
+    bool isMirrored() const { return mirror_ != nullptr; }
+
+protected:
+    // Storage is rounded up to a power of two frames so indexing is a mask;
+    // the usable capacity stays exactly `capacity_frames`.
+    // With `mirrored`, the storage pages are mapped twice back-to-back so
+    // every reserved region is a single contiguous span. Falls back to plain
+    // heap storage (two spans at the wrap) when the mapping is unavailable.
+    RingBufferBase(size_t capacity_frames, size_t frame_bytes, bool mirrored);
+    ~RingBufferBase();
+
+    // Producer: start index and length of up to `count` writable frames.
+    size_t reserveWrite(size_t count, size_t* position) {
+        size_t current_head = head_.load(std::memory_order_relaxed);
+        size_t available = size_ - (current_head - cached_tail_);
+        if (available < count) {
+            // Only touch the consumer's cache line when the ring looks full.
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            available = size_ - (current_head - cached_tail_);
         }
+        *position = current_head;
+        return std::min(count, available);
+    }
 
-        head_.fetch_add(to_write, std::memory_order_release);
-        return to_write;
+    // Consumer: start index and length of up to `count` readable frames.
+    size_t reserveRead(size_t count, size_t* position) {
+        size_t current_tail = tail_.load(std::memory_order_relaxed);
+        size_t available = cached_head_ - current_tail;
+        if (available < count) {
+            // Only touch the producer's cache line when the ring looks empty.
+            cached_head_ = head_.load(std::memory_order_acquire);
+            available = cached_head_ - current_tail;
+        }
+        *position = current_tail;
+        return std::min(count, available);
     }
 
-    size_t read(uint8_t* dest, size_t count) {
-        size_t current_head = head_.load(std::memory_order_acquire);
-        size_t available = current_head - tail_.load(std::memory_order_relaxed);
+    // Read-only after construction.
+    uint8_t* storage_ = nullptr;
+    uint8_t* mirror_ = nullptr;
+    size_t size_;
+    size_t mask_ = 0;
 
-        if (available == 0) return 0;
+private:
+    // Keeps the producer and consumer indices on separate cache lines so
+    // capture and bridge threads on different cores do not false-share.
+    static constexpr size_t kCacheLineSize = 64;
+
+    // Futex word plus the number of threads sleeping on it. The sequence is
+    // only bumped (and the kernel only entered) when waiters is non-zero.
+    struct WaitSignal {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint32_t> waiters{0};
+    };
+
+    bool mapMirrored(size_t storage_bytes);
+    static void wake(WaitSignal& signal);
+    template <typename Ready>
+    bool waitOn(WaitSignal& signal, Ready ready, std::chrono::microseconds timeout);
 
-        size_t to_read = std::min(count, available);
+    std::vector<uint8_t> buffer_;
+    size_t storage_bytes_ = 0;
 
-        size_t read_idx = tail_.load(std::memory_order_relaxed) % size_;
-        size_t first_chunk = std::min(to_read, size_ - read_idx);
+    // Producer line: own index plus its last view of the consumer's.
+    alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
 
-        memcpy(dest, &buffer_[read_idx], first_chunk);
-        if (first_chunk < to_read) {
-            memcpy(dest + first_chunk, &buffer_[0], to_read - first_chunk);
-        }
+    // Consumer line: own index plus its last view of the producer's.
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
 
-        tail_.fetch_add(to_read, std::memory_order_release);
-        return to_read;
+    // Blocking-wait signals, off the index lines; only written while a side
+    // is actually asleep.
+    alignas(kCacheLineSize) WaitSignal readable_;
+    WaitSignal writable_;
+    std::atomic<bool> interrupted_{false};
+};
+
+template <typename Frame>
+class RingBuffer : public RingBufferBase {
+public:
+    // Contiguous piece of ring storage.
+    struct Span {
+        Frame* data = nullptr;
+        size_t frames = 0;
+
+        size_t bytes() const { return frames * sizeof(Frame); }
+    };
+
+    // Reserved region of the ring. Crosses the wrap point as two spans;
+    // `second` is empty when the region is contiguous.
+    struct Regions {
+        Span first;
+        Span second;
+
+        size_t frames() const { return first.frames + second.frames; }
+    };
+
+    explicit RingBuffer(size_t capacity_frames, bool mirrored = false)
+        : RingBufferBase(capacity_frames, sizeof(Frame), mirrored) {}
+
+    // Producer: reserve up to `count` writable frames for in-place fill.
+    // Nothing becomes visible to the consumer until commitWrite().
+    Regions beginWrite(size_t count) {
+        size_t position;
+        size_t frames = reserveWrite(count, &position);
+        return regionsAt(position, frames);
     }
 
-    size_t available() const {
-        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    // Consumer: reserve up to `count` readable frames for in-place drain.
+    // The data stays owned by the consumer (and may be modified in place)
+    // until commitRead() hands the space back to the producer.
+    Regions beginRead(size_t count) {
+        size_t position;
+        size_t frames = reserveRead(count, &position);
+        return regionsAt(position, frames);
     }
 
-    size_t capacity() const {
-        return size_;
+    size_t write(const Frame* data, size_t count) {
+        // Avoid all-or-nothing drops under transient jitter.
+        Regions span = beginWrite(count);
+        if (span.frames() == 0) return 0;
+
+        memcpy(span.first.data, data, span.first.bytes());
+        if (span.second.frames > 0) {
+            memcpy(span.second.data, data + span.first.frames, span.second.bytes());
+        }
+
+        commitWrite(span.frames());
+        return span.frames();
+    }
+
+    size_t read(Frame* dest, size_t count) {
+        Regions span = beginRead(count);
+        if (span.frames() == 0) return 0;
+
+        memcpy(dest, span.first.data, span.first.bytes());
+        if (span.second.frames > 0) {
+            memcpy(dest + span.first.frames, span.second.data, span.second.bytes());
+        }
+
+        commitRead(span.frames());
+        return span.frames();
     }
 
 private:
-    std::vector<uint8_t> buffer_;
-    size_t size_;
-    std::atomic<size_t> head_;
-    std::atomic<size_t> tail_;
+    Frame* frameAt(size_t idx) const {
+        return reinterpret_cast<Frame*>(storage_ + idx * sizeof(Frame));
+    }
+
+    Regions regionsAt(size_t position, size_t count) const {
+        Regions regions;
+        if (count == 0) return regions;
+
+        size_t idx = position & mask_;
+        if (mirror_) {
+            // The second mapping continues where the first ends.
+            regions.first = {frameAt(idx), count};
+            return regions;
+        }
+        size_t first_chunk = std::min(count, mask_ + 1 - idx);
+        regions.first = {frameAt(idx), first_chunk};
+        if (first_chunk < count) {
+            regions.second = {frameAt(0), count - first_chunk};
+        }
+        return regions;
+    }
 };
 
 #endif  // RING_BUFFER_H
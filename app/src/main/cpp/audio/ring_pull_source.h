@@ -0,0 +1,113 @@
+#ifndef RING_PULL_SOURCE_H
+#define RING_PULL_SOURCE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "../dsp/adaptive_resampler.h"
+#include "audio_common.h"
+#include "ring_buffer.h"
+
+// --- Ring Pull Source ---
+// Drains a RingBuffer from inside an output callback. Short reads are
+// zero-filled and counted; one underrun event covers a whole run of short
+// callbacks, so a paused host counts once rather than once per burst.
+// Depends only on the ring, so NullPullAudioEngine, which calls render() on
+// a timer, exercises on a Linux host exactly what the AAudio callback runs.
+template <typename Frame>
+class RingPullSource : public AudioPullSource {
+public:
+    explicit RingPullSource(RingBuffer<Frame>* ring) : ring_(ring) {}
+
+    // Route frames through the adaptive resampler at the ratio last given
+    // to setRatio().
+    void enableResampling(bool enabled) {
+        resampling_.store(enabled, std::memory_order_relaxed);
+    }
+    void setRatio(double ratio) { ratio_.store(ratio, std::memory_order_relaxed); }
+
+    void setMuted(bool muted) { muted_.store(muted, std::memory_order_relaxed); }
+
+    // Callback thread only.
+    size_t render(void* data, size_t frames) override {
+        Frame* out = static_cast<Frame*>(data);
+        size_t got = resampling_.load(std::memory_order_relaxed) ? renderResampled(out, frames)
+                                                                 : renderDirect(out, frames);
+
+        if (got < frames) {
+            memset(out + got, 0, (frames - got) * sizeof(Frame));
+            if (!in_underrun_) {
+                in_underrun_ = true;
+                underruns_.fetch_add(1, std::memory_order_relaxed);
+            }
+            underrun_frames_.fetch_add(frames - got, std::memory_order_relaxed);
+        } else {
+            in_underrun_ = false;
+        }
+        if (muted_.load(std::memory_order_relaxed)) {
+            memset(out, 0, got * sizeof(Frame));
+        }
+
+        rendered_frames_.fetch_add(frames, std::memory_order_relaxed);
+        data_frames_.fetch_add(got, std::memory_order_relaxed);
+        return got;
+    }
+
+    // Readable from any thread.
+    uint64_t underrunCount() const { return underruns_.load(std::memory_order_relaxed); }
+    uint64_t underrunFrames() const { return underrun_frames_.load(std::memory_order_relaxed); }
+    uint64_t renderedFrames() const { return rendered_frames_.load(std::memory_order_relaxed); }
+    // Frames that carried ring data; stops advancing while the host is idle.
+    uint64_t dataFrames() const { return data_frames_.load(std::memory_order_relaxed); }
+
+private:
+    size_t renderDirect(Frame* out, size_t frames) {
+        typename RingBuffer<Frame>::Regions span = ring_->beginRead(frames);
+        if (span.frames() == 0) return 0;
+
+        memcpy(out, span.first.data, span.first.bytes());
+        if (span.second.frames > 0) {
+            memcpy(out + span.first.frames, span.second.data, span.second.bytes());
+        }
+        ring_->commitRead(span.frames());
+        return span.frames();
+    }
+
+    size_t renderResampled(Frame* out, size_t frames) {
+        if (in_underrun_) {
+            // Don't interpolate across the gap.
+            resampler_.reset();
+        }
+        resampler_.setRatio(ratio_.load(std::memory_order_relaxed));
+
+        // A little over one callback's worth covers any ratio within
+        // +-1000 ppm plus the interpolator history.
+        typename RingBuffer<Frame>::Regions span = ring_->beginRead(frames + frames / 64 + 4);
+        size_t consumed = 0;
+        size_t produced =
+            resampler_.process(span.first.data, span.first.frames, out, frames, &consumed);
+        if (consumed == span.first.frames && span.second.frames > 0) {
+            size_t consumedSecond = 0;
+            produced += resampler_.process(span.second.data, span.second.frames, out + produced,
+                                           frames - produced, &consumedSecond);
+            consumed += consumedSecond;
+        }
+        ring_->commitRead(consumed);
+        return produced;
+    }
+
+    RingBuffer<Frame>* ring_;
+    AdaptiveResampler<Frame> resampler_;
+    bool in_underrun_ = false;
+
+    std::atomic<bool> resampling_{false};
+    std::atomic<double> ratio_{1.0};
+    std::atomic<bool> muted_{false};
+    std::atomic<uint64_t> underruns_{0};
+    std::atomic<uint64_t> underrun_frames_{0};
+    std::atomic<uint64_t> rendered_frames_{0};
+    std::atomic<uint64_t> data_frames_{0};
+};
+
+#endif  // RING_PULL_SOURCE_H
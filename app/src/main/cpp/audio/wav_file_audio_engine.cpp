@@ -0,0 +1,70 @@
+#include "wav_file_audio_engine.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../logging/logging.h"
+
+namespace {
+
+// WAV fields are little-endian regardless of the host.
+void putLe(uint8_t* dst, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) dst[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+constexpr size_t kHeaderBytes = 44;
+
+}  // namespace
+
+bool WavFileAudioEngine::open(int rate, int channelCount) {
+    close();
+    rate_ = rate;
+    channels_ = channelCount;
+    dataBytes_ = 0;
+    file_ = fopen(path_.c_str(), "wb");
+    if (!file_) {
+        LOGE("[Native] WAV engine cannot create %s", path_.c_str());
+        return false;
+    }
+    // Placeholder sizes until close().
+    writeHeader();
+    return true;
+}
+
+void WavFileAudioEngine::writeHeader() {
+    uint32_t dataSize = static_cast<uint32_t>(std::min<uint64_t>(dataBytes_, UINT32_MAX - 36));
+    uint32_t blockAlign = static_cast<uint32_t>(channels_) * sizeof(int16_t);
+
+    uint8_t header[kHeaderBytes];
+    memcpy(header, "RIFF", 4);
+    putLe(header + 4, 36 + dataSize, 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    putLe(header + 16, 16, 4);  // fmt chunk size
+    putLe(header + 20, 1, 2);   // PCM
+    putLe(header + 22, static_cast<uint32_t>(channels_), 2);
+    putLe(header + 24, static_cast<uint32_t>(rate_), 4);
+    putLe(header + 28, static_cast<uint32_t>(rate_) * blockAlign, 4);
+    putLe(header + 32, blockAlign, 2);
+    putLe(header + 34, 16, 2);  // Bits per sample
+    memcpy(header + 36, "data", 4);
+    putLe(header + 40, dataSize, 4);
+
+    fseek(file_, 0, SEEK_SET);
+    fwrite(header, 1, sizeof(header), file_);
+}
+
+void WavFileAudioEngine::write(const uint8_t* data, size_t sizeBytes) {
+    if (!file_) return;
+    dataBytes_ += fwrite(data, 1, sizeBytes, file_);
+}
+
+void WavFileAudioEngine::stop() {
+    if (file_) fflush(file_);
+}
+
+void WavFileAudioEngine::close() {
+    if (!file_) return;
+    writeHeader();
+    fclose(file_);
+    file_ = nullptr;
+}
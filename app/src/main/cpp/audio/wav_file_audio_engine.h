@@ -0,0 +1,40 @@
+#ifndef WAV_FILE_AUDIO_ENGINE_H
+#define WAV_FILE_AUDIO_ENGINE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "audio_common.h"
+
+// --- WAV File Output Engine ---
+// Records everything written as 16-bit PCM WAV, for checking what the bridge
+// actually delivered (gaps, resampling, mute) on a host build. The sizes in
+// the header are filled in by close(). write() only blocks on the file, so
+// the pace comes from the capture side.
+class WavFileAudioEngine : public AudioEngine {
+public:
+    explicit WavFileAudioEngine(std::string path) : path_(std::move(path)) {}
+    ~WavFileAudioEngine() override { close(); }
+
+    bool open(int rate, int channelCount) override;
+    void start() override {}
+    void write(const uint8_t* data, size_t sizeBytes) override;
+    void stop() override;
+    void close() override;
+    int getBurstFrames() override { return 192; }
+    int64_t getQueuedFrames() override { return 0; }
+
+    uint64_t bytesWritten() const { return dataBytes_; }
+
+private:
+    void writeHeader();
+
+    const std::string path_;
+    FILE* file_ = nullptr;
+    int rate_ = 48000;
+    int channels_ = 2;
+    uint64_t dataBytes_ = 0;
+};
+
+#endif  // WAV_FILE_AUDIO_ENGINE_H
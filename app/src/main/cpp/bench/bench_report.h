@@ -0,0 +1,95 @@
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// --- Machine-Readable Results ---
+// One record per measurement on stdout: a JSON object per line, or CSV with
+// a header line whenever the columns change. Shared by the host tools so
+// their output can be diffed run to run with the same scripts.
+class Report {
+public:
+    explicit Report(bool csv) : csv_(csv) {}
+
+    void begin(const char* suite) {
+        keys_.clear();
+        values_.clear();
+        add("suite", quote(suite), suite);
+    }
+
+    void field(const char* key, const char* value) { add(key, quote(value), value); }
+    void field(const char* key, const std::string& value) { field(key, value.c_str()); }
+    void field(const char* key, int64_t value) {
+        std::string text = std::to_string(value);
+        add(key, text, text);
+    }
+    void field(const char* key, int value) { field(key, static_cast<int64_t>(value)); }
+    void field(const char* key, size_t value) { field(key, static_cast<int64_t>(value)); }
+    void field(const char* key, bool value) { field(key, static_cast<int64_t>(value ? 1 : 0)); }
+    void field(const char* key, double value) {
+        char text[32];
+        if (std::isfinite(value)) {
+            snprintf(text, sizeof(text), "%.6g", value);
+        } else {
+            snprintf(text, sizeof(text), "null");
+        }
+        add(key, text, std::isfinite(value) ? text : "");
+    }
+
+    void end() {
+        if (csv_) {
+            if (keys_ != header_) {
+                header_ = keys_;
+                printRow(keys_);
+            }
+            std::vector<std::string> cells;
+            for (const auto& value : values_) cells.push_back(value.second);
+            printRow(cells);
+        } else {
+            std::string line = "{";
+            for (size_t i = 0; i < keys_.size(); ++i) {
+                if (i > 0) line += ",";
+                line += quote(keys_[i].c_str()) + ":" + values_[i].first;
+            }
+            line += "}";
+            puts(line.c_str());
+        }
+        fflush(stdout);
+    }
+
+private:
+    void add(const char* key, const std::string& json, const std::string& plain) {
+        keys_.push_back(key);
+        values_.emplace_back(json, plain);
+    }
+
+    static std::string quote(const char* text) {
+        std::string out = "\"";
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') out += '\\';
+            out += *c;
+        }
+        return out + "\"";
+    }
+
+    static void printRow(const std::vector<std::string>& cells) {
+        std::string line;
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (i > 0) line += ",";
+            line += cells[i];
+        }
+        puts(line.c_str());
+    }
+
+    const bool csv_;
+    std::vector<std::string> keys_;
+    std::vector<std::pair<std::string, std::string>> values_;  // JSON, CSV
+    std::vector<std::string> header_;
+};
+
+#endif  // BENCH_REPORT_H
@@ -0,0 +1,587 @@
+// Bridge benchmark suite.
+//
+// Measures the pieces that decide whether the bridge keeps up:
+//   ring      RingBuffer copy and in-place throughput, plus per-call write and
+//             read cost, across capacities, chunk sizes and storage layouts.
+//   pingpong  One-frame round trips between two threads pinned to given
+//             cores, spinning and sleeping on the ring's futex waits.
+//   loop      bridgeTask end to end: the virtual gadget as capture, the ring,
+//             and a paced null engine as output, per engine chunk strategy and
+//             with adaptive latency; engine type 3 runs the pull-mode
+//             supervisor against the timer-driven callback engine.
+//   chunk     Per-period CPU cost of the push loop's chunk and watermark
+//             decision.
+//
+// Every measurement is one record on stdout: a JSON object per line by
+// default, or CSV with --csv (a header line whenever the columns change).
+// Keys are stable so runs can be diffed or loaded into a notebook.
+//
+// Host build (the bridge_bench target of a non-Android CMake build):
+//   cmake -S app/src/main/cpp -B build -DCMAKE_BUILD_TYPE=Release
+//   cmake --build build --target bridge_bench
+//   build/bridge_bench --suite=ring,chunk --quick > before.jsonl
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../audio/null_audio_engine.h"
+#include "../audio/null_pull_audio_engine.h"
+#include "../audio/ring_buffer.h"
+#include "../core/bridge.h"
+#include "../core/bridge_stats.h"
+#include "../core/chunk_strategy.h"
+#include "../core/stop_signal.h"
+#include "../logging/logging.h"
+#include "../sim/virtual_gadget_pcm.h"
+#include "bench_report.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using BenchFrame = FrameS16Stereo;
+using BenchRing = RingBuffer<BenchFrame>;
+
+struct Options {
+    bool csv = false;
+    bool quick = false;
+    bool ring = true;
+    bool pingpong = true;
+    bool loop = true;
+    bool chunk = true;
+    double loopSeconds = 3.0;
+    std::vector<std::pair<int, int>> cpuPairs;
+};
+
+// --- Helpers ---
+
+int64_t nanosSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+// Nearest-rank percentile; sorts in place.
+int64_t percentile(std::vector<int64_t>& samples, double p) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples.size()));
+    return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+bool pinToCpu(int cpu) {
+    if (cpu < 0) return true;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+double processCpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// --- Ring Throughput / Per-Call Cost ---
+
+enum class RingApi { Copy, InPlace };
+
+// Streams totalFrames from a producer thread to the calling thread and
+// returns frames per second. With `costs`, every call that moved data is
+// timed into the two vectors instead (the clock reads then dominate the
+// throughput, so the two are separate runs).
+double runRing(size_t capacity, size_t chunk, bool mirrored, RingApi api, size_t totalFrames,
+               std::vector<int64_t>* writeCosts, std::vector<int64_t>* readCosts,
+               bool* actuallyMirrored) {
+    BenchRing rb(capacity, mirrored);
+    *actuallyMirrored = rb.isMirrored();
+    std::vector<BenchFrame> src(chunk);
+    std::vector<BenchFrame> dst(chunk);
+    for (size_t i = 0; i < chunk; ++i) {
+        src[i].samples[0] = static_cast<int16_t>(i);
+        src[i].samples[1] = static_cast<int16_t>(-static_cast<int>(i));
+    }
+
+    auto transfer = [&](bool producer) {
+        size_t moved;
+        if (api == RingApi::Copy) {
+            moved = producer ? rb.write(src.data(), chunk) : rb.read(dst.data(), chunk);
+        } else if (producer) {
+            BenchRing::Regions span = rb.beginWrite(chunk);
+            if (span.first.frames > 0) {
+                memcpy(span.first.data, src.data(), span.first.bytes());
+            }
+            if (span.second.frames > 0) {
+                memcpy(span.second.data, src.data() + span.first.frames, span.second.bytes());
+            }
+            moved = span.frames();
+            if (moved > 0) rb.commitWrite(moved);
+        } else {
+            // The bridge hands ring storage straight to the engine; a sum
+            // stands in for the engine touching every sample.
+            BenchRing::Regions span = rb.beginRead(chunk);
+            int32_t sum = 0;
+            for (size_t i = 0; i < span.first.frames; ++i) sum += span.first.data[i].samples[0];
+            for (size_t i = 0; i < span.second.frames; ++i) sum += span.second.data[i].samples[0];
+            dst[0].samples[0] = static_cast<int16_t>(sum);
+            moved = span.frames();
+            if (moved > 0) rb.commitRead(moved);
+        }
+        return moved;
+    };
+
+    auto timedTransfer = [&](bool producer, std::vector<int64_t>* costs) {
+        if (!costs) return transfer(producer);
+        auto start = Clock::now();
+        size_t moved = transfer(producer);
+        if (moved > 0) costs->push_back(nanosSince(start));
+        return moved;
+    };
+
+    auto start = Clock::now();
+    std::thread producer([&] {
+        size_t sent = 0;
+        while (sent < totalFrames) {
+            size_t n = timedTransfer(true, writeCosts);
+            if (n == 0) std::this_thread::yield();
+            sent += n;
+        }
+    });
+    size_t received = 0;
+    while (received < totalFrames) {
+        size_t n = timedTransfer(false, readCosts);
+        if (n == 0) std::this_thread::yield();
+        received += n;
+    }
+    producer.join();
+    return totalFrames / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void benchRing(const Options& options, Report& report) {
+    const size_t totalFrames = options.quick ? (16u << 20) : (96u << 20);
+    const size_t costFrames = totalFrames / 16;
+    // Capacities match the bridge's buffer + jitter guard at 48 kHz for the
+    // 20 ms, 100 ms and 400 ms presets; chunks span typical bursts/periods.
+    const size_t capacities[] = {960 + 240, 4800 + 1200, 19200 + 4800};
+    const size_t chunks[] = {48, 96, 192, 240, 480, 960};
+
+    for (size_t capacity : capacities) {
+        for (size_t chunk : chunks) {
+            if (chunk * 2 > capacity) continue;
+            for (bool mirrored : {false, true}) {
+                for (RingApi api : {RingApi::Copy, RingApi::InPlace}) {
+                    bool isMirrored = false;
+                    double fps = runRing(capacity, chunk, mirrored, api, totalFrames, nullptr,
+                                         nullptr, &isMirrored);
+                    if (mirrored && !isMirrored) break;  // No mapping, same as plain
+
+                    std::vector<int64_t> writeCosts;
+                    std::vector<int64_t> readCosts;
+                    writeCosts.reserve(costFrames / chunk + 1);
+                    readCosts.reserve(costFrames / chunk + 1);
+                    runRing(capacity, chunk, mirrored, api, costFrames, &writeCosts, &readCosts,
+                            &isMirrored);
+
+                    report.begin("ring");
+                    report.field("capacity_frames", capacity);
+                    report.field("chunk_frames", chunk);
+                    report.field("mirrored", isMirrored);
+                    report.field("api", api == RingApi::Copy ? "copy" : "inplace");
+                    report.field("frames", totalFrames);
+                    report.field("mframes_per_s", fps / 1e6);
+                    report.field("mb_per_s", fps * sizeof(BenchFrame) / (1024.0 * 1024.0));
+                    report.field("write_calls", writeCosts.size());
+                    report.field("write_ns_p50", percentile(writeCosts, 50));
+                    report.field("write_ns_p99", percentile(writeCosts, 99));
+                    report.field("write_ns_max", percentile(writeCosts, 100));
+                    report.field("read_calls", readCosts.size());
+                    report.field("read_ns_p50", percentile(readCosts, 50));
+                    report.field("read_ns_p99", percentile(readCosts, 99));
+                    report.field("read_ns_max", percentile(readCosts, 100));
+                    report.end();
+                }
+            }
+        }
+    }
+}
+
+// --- Pinned Ping-Pong ---
+
+// Bounces one frame between two threads over a pair of rings. `blocking`
+// sleeps on the ring's futex waits like the bridge threads do; otherwise
+// both sides spin on available().
+void benchPingPongPair(int cpuA, int cpuB, bool blocking, int rounds, Report& report) {
+    BenchRing forward(64);
+    BenchRing back(64);
+    std::atomic<bool> pinnedB{true};
+    const auto waitTimeout = std::chrono::microseconds(100000);
+
+    auto waitFor = [&](BenchRing& rb) {
+        if (blocking) {
+            while (!rb.waitForReadable(1, waitTimeout)) {
+            }
+        } else {
+            while (rb.available() == 0) {
+            }
+        }
+    };
+
+    std::thread echo([&] {
+        pinnedB = pinToCpu(cpuB);
+        BenchFrame frame{};
+        for (int i = 0; i < rounds; ++i) {
+            waitFor(forward);
+            forward.read(&frame, 1);
+            back.write(&frame, 1);
+        }
+    });
+
+    bool pinnedA = pinToCpu(cpuA);
+    std::vector<int64_t> roundTrips;
+    roundTrips.reserve(rounds);
+    BenchFrame frame{};
+    const int warmup = rounds / 10;
+    for (int i = 0; i < rounds; ++i) {
+        auto start = Clock::now();
+        forward.write(&frame, 1);
+        waitFor(back);
+        back.read(&frame, 1);
+        if (i >= warmup) roundTrips.push_back(nanosSince(start));
+    }
+    echo.join();
+    pinToCpu(-1);
+
+    double mean = 0.0;
+    for (int64_t rt : roundTrips) mean += rt;
+    mean /= std::max<size_t>(1, roundTrips.size());
+
+    report.begin("pingpong");
+    report.field("cpu_a", cpuA);
+    report.field("cpu_b", cpuB);
+    report.field("pinned", pinnedA && pinnedB);
+    report.field("wait", blocking ? "futex" : "spin");
+    report.field("rounds", roundTrips.size());
+    report.field("rtt_ns_mean", mean);
+    report.field("rtt_ns_p50", percentile(roundTrips, 50));
+    report.field("rtt_ns_p99", percentile(roundTrips, 99));
+    report.field("rtt_ns_p999", percentile(roundTrips, 99.9));
+    report.field("rtt_ns_max", percentile(roundTrips, 100));
+    report.end();
+}
+
+void benchPingPong(const Options& options, Report& report) {
+    std::vector<std::pair<int, int>> pairs = options.cpuPairs;
+    if (pairs.empty()) {
+        // Neighbouring cores, and the first against the last (often another
+        // cluster or package).
+        int cpus = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+        if (cpus < 2) {
+            pairs.emplace_back(-1, -1);
+        } else {
+            pairs.emplace_back(0, 1);
+            if (cpus > 2) pairs.emplace_back(0, cpus - 1);
+        }
+    }
+    const int spinRounds = options.quick ? 20000 : 200000;
+    const int futexRounds = options.quick ? 5000 : 50000;
+    for (const auto& pair : pairs) {
+        // Spinning against a thread on the same core only measures the
+        // scheduler's time slice.
+        bool sameCore = pair.first == pair.second;
+        if (!sameCore) benchPingPongPair(pair.first, pair.second, false, spinRounds, report);
+        benchPingPongPair(pair.first, pair.second, true, futexRounds, report);
+    }
+}
+
+// --- End-to-End Loop ---
+
+// Null output that remembers how much it was given once the bridge deletes
+// it.
+class CountingNullEngine : public NullAudioEngine {
+public:
+    explicit CountingNullEngine(std::atomic<int64_t>* sink) : NullAudioEngine(true), sink_(sink) {}
+    ~CountingNullEngine() override { sink_->store(framesWritten()); }
+
+private:
+    std::atomic<int64_t>* sink_;
+};
+
+// Callback-mode counterpart: frames of ring data the timer callback pulled.
+class CountingNullPullEngine : public NullPullAudioEngine {
+public:
+    explicit CountingNullPullEngine(std::atomic<int64_t>* sink) : sink_(sink) {}
+    ~CountingNullPullEngine() override { sink_->store(dataFrames()); }
+
+private:
+    std::atomic<int64_t>* sink_;
+};
+
+class BenchBackend : public AudioBackend {
+public:
+    AudioEngine* createOutput(int engineType) override {
+        if (engineType == 3) return new CountingNullPullEngine(&framesWritten);
+        return new CountingNullEngine(&framesWritten);
+    }
+
+    std::atomic<int64_t> framesWritten{0};
+};
+
+// Keeps the bridge's log lines off stdout; the records are the output.
+class QuietLogSink : public LogSink {
+public:
+    void writeLog(int priority, const char* text) override {}
+    void onState(int stateCode) override { state = stateCode; }
+    void onError(const char* message) override { errors++; }
+    void onLatencyTarget(int targetFrames) override { latencyTarget = targetFrames; }
+
+    std::atomic<int> state{0};
+    std::atomic<int> errors{0};
+    std::atomic<int> latencyTarget{0};
+};
+
+QuietLogSink quietSink;
+
+struct LoopCase {
+    int engineType;
+    bool singleThread;
+    int bufferFrames;
+    double driftPpm;
+    double jitterMs;
+    bool adaptiveLatency;
+};
+
+void benchLoopCase(const LoopCase& loop, double seconds, Report& report) {
+    VirtualGadgetConfig gadget;
+    gadget.driftPpm = loop.driftPpm;
+    gadget.jitterMs = loop.jitterMs;
+    virtualGadgetConfigure(gadget);
+
+    BenchBackend backend;
+    setAudioBackend(&backend);
+    isSingleThreadEnabled = loop.singleThread;
+    isRateAdaptationEnabled = false;
+    isAdaptiveLatencyEnabled = loop.adaptiveLatency;
+    latencyTargetHintFrames = 0;
+    quietSink.errors = 0;
+    quietSink.latencyTarget = 0;
+
+    double cpuStart = processCpuSeconds();
+    auto start = Clock::now();
+    isRunning = true;
+    isFinished = false;
+    bridgeStop.clear();
+    std::thread bridge(bridgeTask, static_cast<int>(kVirtualGadgetCard),
+                       static_cast<int>(kVirtualGadgetDevice), loop.bufferFrames, 0,
+                       loop.engineType, static_cast<int>(gadget.rate), 1, 0);
+
+    auto deadline = start + std::chrono::duration<double>(seconds);
+    while (isRunning && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    // Counters are cumulative per start; latency covers the last window.
+    int underruns = bridgeStats.underruns.load();
+    int modeSwitches = bridgeStats.modeSwitches.load();
+    int overruns = bridgeStats.overruns.load();
+    int xruns = bridgeStats.xruns.load();
+    float latencyAvg = bridgeStats.latencyAvgMs.load();
+    float latencyMax = bridgeStats.latencyMaxMs.load();
+    bool stoppedEarly = !isRunning;
+
+    isRunning = false;
+    bridgeStop.raise();
+    bridge.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    double cpu = processCpuSeconds() - cpuStart;
+    setAudioBackend(nullptr);
+
+    VirtualGadgetCounters counters = virtualGadgetCounters();
+    int64_t written = backend.framesWritten.load();
+
+    report.begin("loop");
+    report.field("engine_type", loop.engineType);
+    report.field("single_thread", loop.singleThread);
+    report.field("buffer_frames", loop.bufferFrames);
+    report.field("drift_ppm", loop.driftPpm);
+    report.field("jitter_ms", loop.jitterMs);
+    report.field("adaptive_latency", loop.adaptiveLatency);
+    report.field("seconds", elapsed);
+    report.field("stopped_early", stoppedEarly);
+    report.field("errors", quietSink.errors.load());
+    report.field("captured_frames", counters.framesDelivered);
+    report.field("output_frames", written);
+    report.field("capture_xruns", counters.xruns);
+    report.field("ring_overruns", overruns);
+    report.field("pcm_xruns", xruns);
+    report.field("underruns", underruns);
+    report.field("mode_switches", modeSwitches);
+    report.field("latency_ms_avg", static_cast<double>(latencyAvg));
+    report.field("latency_ms_max", static_cast<double>(latencyMax));
+    // Last target the tuner reported, 0 when it never moved.
+    report.field("latency_target_frames", quietSink.latencyTarget.load());
+    report.field("cpu_percent", 100.0 * cpu / elapsed);
+    report.field("cpu_us_per_ms_audio",
+                 written > 0 ? cpu * 1e6 / (written * 1000.0 / gadget.rate) : 0.0);
+    report.end();
+}
+
+void benchLoop(const Options& options, Report& report) {
+    setLogSink(&quietSink);
+    startLogDrainer();
+
+    // Quick runs still last long enough for one latency window (1 s) to be
+    // published after the pre-roll.
+    double seconds = options.quick ? std::min(options.loopSeconds, 2.0) : options.loopSeconds;
+    const LoopCase cases[] = {
+        {0, false, 1920, 0.0, 0.0, false},   // AAudio chunking, clean host
+        {1, false, 1920, 0.0, 0.0, false},   // OpenSL chunking
+        {2, false, 1920, 0.0, 0.0, false},   // AudioTrack chunking
+        {3, false, 1920, 0.0, 0.0, false},   // AAudio callback: timer-driven pull
+        {0, true, 1920, 0.0, 0.0, false},    // Single-thread mode
+        {0, false, 960, 300.0, 1.0, false},  // Small buffer, drifting and jittery host
+        {0, true, 960, 300.0, 1.0, false},
+        {0, false, 1920, 0.0, 0.0, true},    // Adaptive latency, clean host
+        {0, false, 1920, 300.0, 1.0, true},  // Adaptive latency, jittery host
+    };
+    for (const LoopCase& loop : cases) {
+        benchLoopCase(loop, seconds, report);
+    }
+}
+
+// --- Chunk / Watermark Decision ---
+
+void benchChunk(const Options& options, Report& report) {
+    const size_t iterations = options.quick ? 2000000 : 20000000;
+    const int engineTypes[] = {0, 1, 2};
+    const size_t capacities[] = {960 + 240, 4800 + 1200};
+
+    for (int engineType : engineTypes) {
+        for (size_t capacity : capacities) {
+            // Strategy setup runs once per stream start.
+            const int setupRounds = 100000;
+            auto setupStart = Clock::now();
+            size_t guard = 0;
+            for (int i = 0; i < setupRounds; ++i) {
+                guard += ChunkStrategy::forEngine(engineType, 192 + (i & 7), 240, capacity)
+                             .highWaterFrames;
+            }
+            double setupNs = nanosSince(setupStart) / static_cast<double>(setupRounds);
+
+            // A fill trace that keeps crossing both watermarks, with a
+            // clock that advances one period per step so the dwell allows
+            // switches. Precomputed, so only the decision is timed.
+            ChunkStrategy strategy = ChunkStrategy::forEngine(engineType, 192, 240, capacity);
+            std::vector<size_t> fills(4096);
+            std::mt19937 rng(1);
+            for (size_t i = 0; i < fills.size(); ++i) {
+                double phase = std::sin(i * 2.0 * M_PI / 512.0);
+                size_t noise = rng() % (strategy.normalFrames + 1);
+                fills[i] = std::min(capacity, static_cast<size_t>((phase + 1.0) * capacity / 2.0) +
+                                                  noise / 2);
+            }
+            const auto period = std::chrono::microseconds(5000);
+
+            ChunkSelector selector(strategy, Clock::time_point());
+            Clock::time_point now;
+            auto start = Clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                now += period;
+                selector.update(fills[i & (fills.size() - 1)], now);
+                guard += selector.chunkFrames();
+            }
+            double periodNs = nanosSince(start) / static_cast<double>(iterations);
+
+            report.begin("chunk");
+            report.field("engine_type", engineType);
+            report.field("backend", strategy.backendName);
+            report.field("capacity_frames", capacity);
+            report.field("normal_frames", strategy.normalFrames);
+            report.field("reduced_frames", strategy.reducedFrames);
+            report.field("low_water_frames", strategy.lowWaterFrames);
+            report.field("high_water_frames", strategy.highWaterFrames);
+            report.field("setup_ns", setupNs);
+            report.field("iterations", iterations);
+            report.field("switches", selector.switchCount());
+            report.field("ns_per_period", periodNs);
+            report.field("checksum", static_cast<int64_t>(guard & 0xffff));
+            report.end();
+        }
+    }
+}
+
+// --- Command Line ---
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--csv] [--quick] [--suite=ring,pingpong,loop,chunk]\n"
+            "          [--cpus=A:B[,C:D...]] [--loop-seconds=S]\n",
+            argv0);
+}
+
+bool parseOptions(int argc, char** argv, Options* options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--csv") {
+            options->csv = true;
+        } else if (arg == "--quick") {
+            options->quick = true;
+        } else if (arg.rfind("--suite=", 0) == 0) {
+            std::string list = "," + arg.substr(8) + ",";
+            auto has = [&](const char* name) {
+                return list.find(std::string(",") + name + ",") != std::string::npos;
+            };
+            options->ring = has("ring");
+            options->pingpong = has("pingpong");
+            options->loop = has("loop");
+            options->chunk = has("chunk");
+        } else if (arg.rfind("--cpus=", 0) == 0) {
+            const char* p = arg.c_str() + 7;
+            while (*p) {
+                int a = -1;
+                int b = -1;
+                int consumed = 0;
+                if (sscanf(p, "%d:%d%n", &a, &b, &consumed) != 2) return false;
+                options->cpuPairs.emplace_back(a, b);
+                p += consumed;
+                if (*p == ',') ++p;
+            }
+        } else if (arg.rfind("--loop-seconds=", 0) == 0) {
+            options->loopSeconds = atof(arg.c_str() + 15);
+            if (options->loopSeconds <= 0.0) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, &options)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Report report(options.csv);
+    if (options.chunk) benchChunk(options, report);
+    if (options.ring) benchRing(options, report);
+    if (options.pingpong) benchPingPong(options, report);
+    if (options.loop) benchLoop(options, report);
+    return 0;
+}
@@ -0,0 +1,221 @@
+// Offline drift/jitter simulation of the speaker path.
+//
+// Runs one timing scenario (see SimScenario) through each buffer strategy in
+// virtual time and prints one record per strategy: underruns, overruns,
+// latency distribution and mode switches. A minute of audio takes
+// milliseconds, and every strategy sees the same seeded timing.
+//
+// Strategies are "name[:key=value,...]" with keys guard, preroll, normal,
+// reduced, low, high (frames) and dwell (ms); anything not given stays what
+// bridgeTask would use. Without --strategy, the bridge's own policy runs
+// next to a fixed chunk (no reduced mode) for reference.
+//
+// Host build (the bridge_sim target of a non-Android CMake build):
+//   cmake --build build --target bridge_sim
+//   build/bridge_sim --host-drift-ppm=300 --host-jitter-ms=1 --capture-stall=2:15
+//       --strategy=default --strategy=wide:low=480,high=1800
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../sim/bridge_simulator.h"
+#include "bench_report.h"
+
+namespace {
+
+bool parseStrategy(const char* spec, SimStrategy* strategy) {
+    *strategy = SimStrategy();
+    const char* colon = strchr(spec, ':');
+    strategy->name = colon ? std::string(spec, colon - spec) : std::string(spec);
+    if (strategy->name.empty()) return false;
+    if (!colon) return true;
+
+    std::string list = colon + 1;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string item = list.substr(start, end - start);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string key = item.substr(0, eq);
+        char* tail = nullptr;
+        long long value = strtoll(item.c_str() + eq + 1, &tail, 10);
+        if (*tail != '\0' || value < 0) return false;
+
+        if (key == "guard") {
+            strategy->guardFrames = value;
+        } else if (key == "preroll") {
+            strategy->prerollFrames = value;
+        } else if (key == "normal") {
+            strategy->normalFrames = value;
+        } else if (key == "reduced") {
+            strategy->reducedFrames = value;
+        } else if (key == "low") {
+            strategy->lowWaterFrames = value;
+        } else if (key == "high") {
+            strategy->highWaterFrames = value;
+        } else if (key == "dwell") {
+            strategy->dwellMs = value;
+        } else {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+// "--name=value" into a double; false when `arg` is not that option.
+bool optionValue(const std::string& arg, const char* name, double* value, bool* bad) {
+    std::string prefix = std::string("--") + name + "=";
+    if (arg.rfind(prefix, 0) != 0) return false;
+    char* tail = nullptr;
+    *value = strtod(arg.c_str() + prefix.size(), &tail);
+    if (*tail != '\0') *bad = true;
+    return true;
+}
+
+// "--name=INTERVAL_S:LENGTH_MS".
+bool stallValue(const std::string& arg, const char* name, double* intervalSec,
+                double* lengthMs, bool* bad) {
+    std::string prefix = std::string("--") + name + "=";
+    if (arg.rfind(prefix, 0) != 0) return false;
+    if (sscanf(arg.c_str() + prefix.size(), "%lf:%lf", intervalSec, lengthMs) != 2) *bad = true;
+    return true;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--csv] [--strategy=NAME[:key=value,...]]...\n"
+            "  scenario: --rate= --engine= --buffer= --period= --periods= --seconds= --seed=\n"
+            "            --host-drift-ppm= --host-jitter-ms= --wake-jitter-ms=\n"
+            "            --capture-stall=INTERVAL_S:MS --output-stall=INTERVAL_S:MS\n"
+            "            --device-burst= --device-buffer= --device-drift-ppm=\n"
+            "            --device-jitter-ms=\n"
+            "  replay:   --capture-trace=FILE --device-trace=FILE\n"
+            "            (\"<time_ns> <frames>\" per line: ring commits / device reads)\n"
+            "  strategy keys: guard preroll normal reduced low high (frames), dwell (ms)\n",
+            argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    SimScenario scenario;
+    std::vector<SimStrategy> strategies;
+    bool csv = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        double value = 0.0;
+        bool bad = false;
+        if (arg == "--csv") {
+            csv = true;
+        } else if (arg.rfind("--strategy=", 0) == 0) {
+            SimStrategy strategy;
+            if (!parseStrategy(arg.c_str() + 11, &strategy)) bad = true;
+            strategies.push_back(strategy);
+        } else if (arg.rfind("--capture-trace=", 0) == 0) {
+            if (!loadTimingTrace(arg.c_str() + 16, &scenario.captureTrace)) {
+                fprintf(stderr, "cannot read capture trace %s\n", arg.c_str() + 16);
+                return 1;
+            }
+        } else if (arg.rfind("--device-trace=", 0) == 0) {
+            if (!loadTimingTrace(arg.c_str() + 15, &scenario.deviceTrace)) {
+                fprintf(stderr, "cannot read device trace %s\n", arg.c_str() + 15);
+                return 1;
+            }
+        } else if (optionValue(arg, "rate", &value, &bad)) {
+            scenario.rate = static_cast<int>(value);
+        } else if (optionValue(arg, "engine", &value, &bad)) {
+            scenario.engineType = static_cast<int>(value);
+        } else if (optionValue(arg, "buffer", &value, &bad)) {
+            scenario.bufferSizeFrames = static_cast<int>(value);
+        } else if (optionValue(arg, "period", &value, &bad)) {
+            scenario.periodFrames = static_cast<int>(value);
+        } else if (optionValue(arg, "periods", &value, &bad)) {
+            scenario.periodCount = static_cast<int>(value);
+        } else if (optionValue(arg, "seconds", &value, &bad)) {
+            scenario.seconds = value;
+        } else if (optionValue(arg, "seed", &value, &bad)) {
+            scenario.seed = static_cast<uint32_t>(value);
+        } else if (optionValue(arg, "host-drift-ppm", &value, &bad)) {
+            scenario.hostDriftPpm = value;
+        } else if (optionValue(arg, "host-jitter-ms", &value, &bad)) {
+            scenario.hostJitterMs = value;
+        } else if (optionValue(arg, "wake-jitter-ms", &value, &bad)) {
+            scenario.wakeJitterMs = value;
+        } else if (stallValue(arg, "capture-stall", &scenario.captureStallIntervalSec,
+                              &scenario.captureStallMs, &bad)) {
+        } else if (stallValue(arg, "output-stall", &scenario.outputStallIntervalSec,
+                              &scenario.outputStallMs, &bad)) {
+        } else if (optionValue(arg, "device-burst", &value, &bad)) {
+            scenario.deviceBurstFrames = static_cast<int>(value);
+        } else if (optionValue(arg, "device-buffer", &value, &bad)) {
+            scenario.deviceBufferFrames = static_cast<int>(value);
+        } else if (optionValue(arg, "device-drift-ppm", &value, &bad)) {
+            scenario.deviceDriftPpm = value;
+        } else if (optionValue(arg, "device-jitter-ms", &value, &bad)) {
+            scenario.deviceJitterMs = value;
+        } else {
+            bad = true;
+        }
+        if (bad) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (strategies.empty()) {
+        parseStrategy("default", &strategies.emplace_back());
+        // Reduced chunk equal to the normal one: toggling has no effect.
+        SimStrategy fixed;
+        fixed.name = "fixed-chunk";
+        BufferPlan plan = BufferPlan::forRequest(scenario.bufferSizeFrames, scenario.rate);
+        fixed.reducedFrames = ChunkStrategy::forEngine(scenario.engineType,
+                                                       scenario.deviceBurstFrames,
+                                                       scenario.periodFrames, plan.ringFrames())
+                                  .normalFrames;
+        strategies.push_back(fixed);
+    }
+
+    Report report(csv);
+    for (const SimStrategy& strategy : strategies) {
+        SimResult r = simulateBridge(scenario, strategy);
+        report.begin("sim");
+        report.field("strategy", strategy.name);
+        report.field("engine_type", scenario.engineType);
+        report.field("rate", scenario.rate);
+        report.field("seconds", r.seconds);
+        report.field("ring_frames", r.plan.ringFrames());
+        report.field("guard_frames", r.plan.guardFrames);
+        report.field("preroll_frames", r.plan.prerollFrames);
+        report.field("normal_frames", r.chunking.normalFrames);
+        report.field("reduced_frames", r.chunking.reducedFrames);
+        report.field("low_water_frames", r.chunking.lowWaterFrames);
+        report.field("high_water_frames", r.chunking.highWaterFrames);
+        report.field("dwell_ms", static_cast<int64_t>(r.chunking.minModeDwell.count()));
+        report.field("captured_frames", r.capturedFrames);
+        report.field("played_frames", r.playedFrames);
+        report.field("ring_underruns", r.ringUnderruns);
+        report.field("device_underruns", r.deviceUnderruns);
+        report.field("silence_frames", r.silenceFrames);
+        report.field("overruns", r.overruns);
+        report.field("overrun_frames", r.overrunFrames);
+        report.field("capture_xruns", r.captureXruns);
+        report.field("xrun_frames", r.xrunFrames);
+        report.field("mode_switches", r.modeSwitches);
+        report.field("reduced_percent", r.reducedPercent);
+        report.field("latency_ms_min", r.latencyMinMs);
+        report.field("latency_ms_mean", r.latencyMeanMs);
+        report.field("latency_ms_p50", r.latencyP50Ms);
+        report.field("latency_ms_p95", r.latencyP95Ms);
+        report.field("latency_ms_p99", r.latencyP99Ms);
+        report.field("latency_ms_max", r.latencyMaxMs);
+        report.end();
+    }
+    return 0;
+}
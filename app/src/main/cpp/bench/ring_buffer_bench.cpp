@@ -0,0 +1,144 @@
+// RingBuffer throughput microbenchmark.
+//
+// Streams the same amount of 16-bit stereo audio through the current
+// RingBuffer and through the previous layout (adjacent atomics, modulo
+// indexing, peer index reloaded on every call) from a producer thread to a
+// consumer thread, and prints MB/s for each.
+//
+// Host build (the ring_buffer_bench target of a non-Android CMake build):
+//   cmake -S app/src/main/cpp -B build -DCMAKE_BUILD_TYPE=Release
+//   cmake --build build --target ring_buffer_bench
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "../audio/ring_buffer.h"
+
+namespace {
+
+// Ring layout before cache-line separation and cached peer indices.
+class LegacyRingBuffer {
+public:
+    LegacyRingBuffer(size_t size_bytes) : size_(size_bytes), head_(0), tail_(0) {
+        buffer_.resize(size_);
+    }
+
+    size_t write(const uint8_t* data, size_t count) {
+        size_t current_tail = tail_.load(std::memory_order_acquire);
+        size_t available = size_ - (head_.load(std::memory_order_relaxed) - current_tail);
+        size_t to_write = std::min(count, available);
+        to_write -= (to_write % 4);
+        if (to_write == 0) return 0;
+
+        size_t write_idx = head_.load(std::memory_order_relaxed) % size_;
+        size_t first_chunk = std::min(to_write, size_ - write_idx);
+
+        memcpy(&buffer_[write_idx], data, first_chunk);
+        if (first_chunk < to_write) {
+            memcpy(&buffer_[0], data + first_chunk, to_write - first_chunk);
+        }
+
+        head_.fetch_add(to_write, std::memory_order_release);
+        return to_write;
+    }
+
+    size_t read(uint8_t* dest, size_t count) {
+        size_t current_head = head_.load(std::memory_order_acquire);
+        size_t available = current_head - tail_.load(std::memory_order_relaxed);
+        if (available == 0) return 0;
+
+        size_t to_read = std::min(count, available);
+        size_t read_idx = tail_.load(std::memory_order_relaxed) % size_;
+        size_t first_chunk = std::min(to_read, size_ - read_idx);
+
+        memcpy(dest, &buffer_[read_idx], first_chunk);
+        if (first_chunk < to_read) {
+            memcpy(dest + first_chunk, &buffer_[0], to_read - first_chunk);
+        }
+
+        tail_.fetch_add(to_read, std::memory_order_release);
+        return to_read;
+    }
+
+private:
+    std::vector<uint8_t> buffer_;
+    size_t size_;
+    std::atomic<size_t> head_;
+    std::atomic<size_t> tail_;
+};
+
+// Byte-oriented view of the frame-typed ring so both classes share a driver.
+class FrameRing {
+public:
+    FrameRing(size_t size_bytes) : ring_(size_bytes / sizeof(FrameS16Stereo)) {}
+
+    size_t write(const uint8_t* data, size_t count) {
+        return ring_.write(reinterpret_cast<const FrameS16Stereo*>(data),
+                           count / sizeof(FrameS16Stereo)) *
+               sizeof(FrameS16Stereo);
+    }
+
+    size_t read(uint8_t* dest, size_t count) {
+        return ring_.read(reinterpret_cast<FrameS16Stereo*>(dest),
+                          count / sizeof(FrameS16Stereo)) *
+               sizeof(FrameS16Stereo);
+    }
+
+private:
+    RingBuffer<FrameS16Stereo> ring_;
+};
+
+template <typename Ring>
+double runThroughput(size_t capacityBytes, size_t chunkBytes, size_t totalBytes) {
+    Ring rb(capacityBytes);
+    std::vector<uint8_t> src(chunkBytes, 0x5a);
+    std::vector<uint8_t> dst(chunkBytes);
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+        size_t sent = 0;
+        while (sent < totalBytes) {
+            size_t n = rb.write(src.data(), std::min(chunkBytes, totalBytes - sent));
+            if (n == 0) std::this_thread::yield();
+            sent += n;
+        }
+    });
+
+    size_t received = 0;
+    while (received < totalBytes) {
+        size_t n = rb.read(dst.data(), chunkBytes);
+        if (n == 0) std::this_thread::yield();
+        received += n;
+    }
+    producer.join();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    return (totalBytes / (1024.0 * 1024.0)) / elapsed.count();
+}
+
+}  // namespace
+
+int main() {
+    const size_t totalBytes = 512u * 1024 * 1024;
+    // Capacities match the bridge's buffer + jitter guard at 48 kHz
+    // (e.g. 20 ms and 100 ms presets), chunks span typical bursts/periods.
+    const size_t capacities[] = {(960 + 240) * 4, (4800 + 1200) * 4};
+    const size_t chunks[] = {96 * 4, 240 * 4, 480 * 4};
+
+    printf("%-10s %-8s %12s %12s %8s\n", "capacity", "chunk", "legacy MB/s", "ring MB/s",
+           "speedup");
+    for (size_t capacity : capacities) {
+        for (size_t chunk : chunks) {
+            double legacy = runThroughput<LegacyRingBuffer>(capacity, chunk, totalBytes);
+            double current = runThroughput<FrameRing>(capacity, chunk, totalBytes);
+            printf("%-10zu %-8zu %12.1f %12.1f %7.2fx\n", capacity, chunk, legacy, current,
+                   current / legacy);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,272 @@
+// Host check of the callback (pull) output path.
+//
+// RingPullSource only ever runs inside the AAudio data callback on a phone;
+// here it is driven directly and through NullPullAudioEngine, the timer
+// callback host builds use for engine type 3:
+//   underrun   Short renders are zero-filled; underrunCount() counts once per
+//              dry spell while underrunFrames() counts every missing frame.
+//   resample   The resampling path fills whole callbacks, consumes input at
+//              the set ratio and recovers cleanly after a gap.
+//   driver     The timer callback renders at the stream rate from its own
+//              thread and stops rendering on stop().
+//   bridge     bridgeTask's supervisor loop on the virtual gadget: streaming,
+//              idle detection during a host pause, and restart when data
+//              returns.
+//
+// Host build (registered with ctest):
+//   cmake --build build --target pull_mode_check && ctest --test-dir build
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../audio/null_pull_audio_engine.h"
+#include "../audio/ring_buffer.h"
+#include "../audio/ring_pull_source.h"
+#include "../core/bridge.h"
+#include "../core/bridge_stats.h"
+#include "../core/stop_signal.h"
+#include "../logging/logging.h"
+#include "../sim/virtual_gadget_pcm.h"
+
+namespace {
+
+using Frame = FrameS16Stereo;
+using Ring = RingBuffer<Frame>;
+
+int failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                          \
+        }                                                                        \
+    } while (0)
+
+// Frames numbered from `first`, never zero.
+void fill(Ring& ring, size_t frames, int first = 1) {
+    std::vector<Frame> data(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        data[i].samples[0] = static_cast<int16_t>(first + i);
+        data[i].samples[1] = static_cast<int16_t>(-(first + static_cast<int>(i)));
+    }
+    ring.write(data.data(), frames);
+}
+
+bool allZero(const Frame* frames, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (frames[i].samples[0] != 0 || frames[i].samples[1] != 0) return false;
+    }
+    return true;
+}
+
+// --- Underrun Accounting ---
+
+void checkUnderrun() {
+    Ring ring(1024);
+    RingPullSource<Frame> source(&ring);
+    std::vector<Frame> out(192);
+
+    fill(ring, 100);
+    memset(out.data(), 0x55, out.size() * sizeof(Frame));
+    CHECK(source.render(out.data(), 192) == 100);
+    CHECK(out[0].samples[0] == 1 && out[99].samples[0] == 100);
+    CHECK(allZero(out.data() + 100, 92));
+    CHECK(source.underrunCount() == 1);
+    CHECK(source.underrunFrames() == 92);
+
+    // Still dry: more silence, same event.
+    memset(out.data(), 0x55, out.size() * sizeof(Frame));
+    CHECK(source.render(out.data(), 192) == 0);
+    CHECK(allZero(out.data(), 192));
+    CHECK(source.underrunCount() == 1);
+    CHECK(source.underrunFrames() == 92 + 192);
+
+    // Data back, then a second dry spell.
+    fill(ring, 400, 101);
+    CHECK(source.render(out.data(), 192) == 192);
+    CHECK(out[0].samples[0] == 101);
+    CHECK(source.render(out.data(), 192) == 192);
+    CHECK(source.render(out.data(), 192) == 16);
+    CHECK(source.underrunCount() == 2);
+    CHECK(source.underrunFrames() == 92 + 192 + 176);
+
+    CHECK(source.renderedFrames() == 5 * 192);
+    CHECK(source.dataFrames() == 100 + 192 + 192 + 16);
+
+    // Muting keeps the accounting but silences the data.
+    fill(ring, 192);
+    source.setMuted(true);
+    CHECK(source.render(out.data(), 192) == 192);
+    CHECK(allZero(out.data(), 192));
+}
+
+// --- Resampling Path ---
+
+void checkResample() {
+    Ring ring(8192);
+    RingPullSource<Frame> source(&ring);
+    source.enableResampling(true);
+    source.setRatio(1.001);
+    std::vector<Frame> out(192);
+
+    fill(ring, 4000);
+    size_t rendered = 0;
+    for (int i = 0; i < 10; ++i) {
+        CHECK(source.render(out.data(), 192) == 192);
+        CHECK(!allZero(out.data(), 192));
+        rendered += 192;
+    }
+    // Input consumed at the ratio, give or take the interpolator history.
+    double consumed = 4000.0 - ring.available();
+    CHECK(consumed > rendered * 1.001 - 8 && consumed < rendered * 1.001 + 8);
+    CHECK(source.underrunCount() == 0);
+
+    // Run dry: the short callback is zero-filled and counted once.
+    size_t got;
+    int renders = 0;
+    do {
+        got = source.render(out.data(), 192);
+        renders++;
+    } while (got == 192 && renders < 100);
+    CHECK(got < 192);
+    CHECK(allZero(out.data() + got, 192 - got));
+    CHECK(source.render(out.data(), 192) == 0);
+    CHECK(source.underrunCount() == 1);
+
+    // The resampler restarts cleanly after the gap.
+    fill(ring, 2000);
+    CHECK(source.render(out.data(), 192) == 192);
+    CHECK(source.render(out.data(), 192) == 192);
+    CHECK(source.underrunCount() == 1);
+}
+
+// --- Timer Callback Driver ---
+
+void checkDriver() {
+    Ring ring(16384);
+    RingPullSource<Frame> source(&ring);
+    NullPullAudioEngine engine;
+    CHECK(engine.setPullSource(&source));
+    CHECK(engine.open(48000, Frame::kChannels));
+    fill(ring, 16000);
+
+    engine.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    int64_t queued = engine.getQueuedFrames();
+    engine.stop();
+
+    // 200 ms is 9600 frames; the bounds only allow for a loaded host.
+    int64_t rendered = engine.framesRendered();
+    CHECK(rendered >= 4800 && rendered <= 12000);
+    CHECK(rendered % engine.getBurstFrames() == 0);
+    CHECK(static_cast<int64_t>(source.renderedFrames()) == rendered);
+    CHECK(engine.dataFrames() == rendered);
+    CHECK(source.underrunCount() == 0);
+    CHECK(queued >= 0 && queued <= 2 * engine.getBurstFrames());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(engine.framesRendered() == rendered);
+}
+
+// --- Bridge Supervisor ---
+
+class StateLogSink : public LogSink {
+public:
+    void writeLog(int priority, const char* text) override {}
+    void onState(int stateCode) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        states.push_back(stateCode);
+    }
+
+    std::mutex mutex;
+    std::vector<int> states;
+};
+
+StateLogSink stateSink;
+
+class PullBackend : public AudioBackend {
+public:
+    AudioEngine* createOutput(int engineType) override {
+        return new NullPullAudioEngine();
+    }
+};
+
+void checkBridge() {
+    setLogSink(&stateSink);
+    startLogDrainer();
+
+    // Host pauses of 1.5 s every 1-3 s: longer than the 1 s idle timeout,
+    // and the gadget has no host events to report them sooner.
+    VirtualGadgetConfig gadget;
+    gadget.stallIntervalSec = 2.0;
+    gadget.stallMs = 1500.0;
+    virtualGadgetConfigure(gadget);
+
+    PullBackend backend;
+    setAudioBackend(&backend);
+    isRateAdaptationEnabled = false;
+    isAdaptiveLatencyEnabled = false;
+    isRunning = true;
+    isFinished = false;
+    bridgeStop.clear();
+    std::thread bridge(bridgeTask, static_cast<int>(kVirtualGadgetCard),
+                       static_cast<int>(kVirtualGadgetDevice), 1920, 0, 3,
+                       static_cast<int>(gadget.rate), 1, 0);
+
+    // Until the host has come back from its pause and streamed a while.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(8);
+    while (std::chrono::steady_clock::now() < deadline && isRunning) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    int underruns = bridgeStats.underruns.load();
+    bool stoppedEarly = !isRunning;
+    isRunning = false;
+    bridgeStop.raise();
+    bridge.join();
+    setAudioBackend(nullptr);
+
+    std::vector<int> states;
+    {
+        std::lock_guard<std::mutex> lock(stateSink.mutex);
+        states = stateSink.states;
+    }
+    // STREAMING (3), IDLING (4) during the pause, STREAMING again, and
+    // STOPPED (0) at the end.
+    size_t streaming = 0, idle = 0, resumed = 0;
+    for (size_t i = 0; i < states.size(); ++i) {
+        if (states[i] == 3 && !streaming) streaming = i + 1;
+        if (states[i] == 4 && streaming && !idle) idle = i + 1;
+        if (states[i] == 3 && idle && !resumed) resumed = i + 1;
+    }
+    VirtualGadgetCounters counters = virtualGadgetCounters();
+    CHECK(!stoppedEarly);
+    CHECK(counters.stalls >= 1);
+    CHECK(streaming > 0);
+    CHECK(idle > 0);
+    CHECK(resumed > 0);
+    CHECK(!states.empty() && states.back() == 0);
+    // The pause drains the ring: at least one callback underrun, reported
+    // as one event rather than one per burst.
+    CHECK(underruns >= 1 && underruns <= 4 * counters.stalls);
+}
+
+}  // namespace
+
+int main() {
+    checkUnderrun();
+    checkResample();
+    checkDriver();
+    checkBridge();
+    if (failures > 0) {
+        fprintf(stderr, "pull_mode_check: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("pull_mode_check: ok\n");
+    return 0;
+}
@@ -1,207 +1,684 @@
 #include "bridge.h"
 
+#include <poll.h>
+#include <sys/timerfd.h>
 #include <tinyalsa/pcm.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <cerrno>
+#include <climits>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
 #include <cstring>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
-#include "../audio/aaudio_engine.h"
 #include "../audio/audio_common.h"
-#include "../audio/java_audio_track_engine.h"
-#include "../audio/opensl_engine.h"
+#include "../audio/null_audio_engine.h"
+#include "../audio/null_pull_audio_engine.h"
 #include "../audio/ring_buffer.h"
+#include "../audio/ring_pull_source.h"
+#include "../dsp/adaptive_resampler.h"
+#include "../dsp/drift_estimator.h"
+#include "../dsp/rate_controller.h"
 #include "../logging/logging.h"
+#include "bridge_stats.h"
+#include "buffer_plan.h"
+#include "chunk_strategy.h"
+#include "host_activity_monitor.h"
+#include "host_pitch_control.h"
+#include "latency_accountant.h"
+#include "latency_tuner.h"
+#include "stop_signal.h"
+#include "thread_scheduling.h"
+
+// Frame layout carried from the gadget through the ring to the engines.
+// Changing it here retypes the whole speaker path at compile time.
+using BridgeFrame = FrameS16Stereo;
+using BridgeRingBuffer = RingBuffer<BridgeFrame>;
+
+template <typename Sample> constexpr pcm_format pcmFormatFor();
+template <> constexpr pcm_format pcmFormatFor<int16_t>() { return PCM_FORMAT_S16_LE; }
+template <> constexpr pcm_format pcmFormatFor<Int24>() { return PCM_FORMAT_S24_3LE; }
+template <> constexpr pcm_format pcmFormatFor<int32_t>() { return PCM_FORMAT_S32_LE; }
+template <> constexpr pcm_format pcmFormatFor<float>() { return PCM_FORMAT_FLOAT_LE; }
+
+// Minimum spacing of clock samples fed to the drift estimator. Timestamp
+// queries are ioctls, and the estimator only keeps about one point per second.
+static constexpr std::chrono::milliseconds kDriftSampleInterval{500};
+
+static int64_t toNanos(const struct timespec &ts) {
+  return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int64_t monotonicNanos(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch())
+      .count();
+}
+
+// How often the audio threads refresh their section of bridgeStats. The UI
+// polls at its own rate; this only bounds how stale a value can be.
+static constexpr std::chrono::milliseconds kStatsPublishInterval{250};
+
+// Latency is sampled often enough to catch the sawtooth of period-sized
+// writes and summarised (min/avg/max) once per window.
+static constexpr std::chrono::milliseconds kLatencySampleInterval{20};
+static constexpr std::chrono::milliseconds kLatencyWindow{1000};
+
+// Upper bound for blocking waits while the host is silent. Stop interrupts
+// the waits directly, so this only paces idle detection.
+static constexpr std::chrono::milliseconds kRingWaitTimeout{100};
+
+// Adaptive latency: capture gaps longer than this are the host pausing, not
+// jitter. A re-prime after an underrun gives up waiting for the target fill
+// after kReprimeTimeout.
+static constexpr std::chrono::milliseconds kMaxCaptureGap{250};
+static constexpr std::chrono::milliseconds kReprimeTimeout{500};
+
+// A zero-timeout pcm_wait() turns POLLERR on the capture fd into the
+// XRUN/disconnect code CaptureStream::step() expects. 0 means not ready.
+static int captureWaitResult(struct pcm *pcm, short revents) {
+  if (revents & POLLIN)
+    return 1;
+  return (revents & (POLLERR | POLLNVAL)) ? pcm_wait(pcm, 0) : 0;
+}
+
+// Output section of bridgeStats. Tracks the ring fill between publishes so
+// min/max cover the whole window rather than the instants that happen to be
+// sampled.
+class OutputStatsPublisher {
+public:
+  void observe(size_t fill) {
+    fillMin_ = std::min(fillMin_, fill);
+    fillMax_ = std::max(fillMax_, fill);
+  }
+
+  void publish(size_t fill, uint64_t underruns, int modeSwitches, double driftPpm) {
+    observe(fill);
+    {
+      StatsUpdate update(bridgeStats.outputSequence);
+      bridgeStats.ringFill.store((int32_t)fill, std::memory_order_relaxed);
+      bridgeStats.ringFillMin.store((int32_t)fillMin_, std::memory_order_relaxed);
+      bridgeStats.ringFillMax.store((int32_t)fillMax_, std::memory_order_relaxed);
+      bridgeStats.underruns.store((int32_t)underruns, std::memory_order_relaxed);
+      bridgeStats.modeSwitches.store(modeSwitches, std::memory_order_relaxed);
+      bridgeStats.driftPpm.store((float)driftPpm, std::memory_order_relaxed);
+      bridgeStats.outputCpuMs.store(threadCpuMillis(), std::memory_order_relaxed);
+    }
+    publishThreadScheduling(AudioThreadRole::Output);
+    fillMin_ = fill;
+    fillMax_ = fill;
+  }
+
+private:
+  size_t fillMin_ = SIZE_MAX;
+  size_t fillMax_ = 0;
+};
+
+static void publishConfigStats(int rate, int period, int bufferSize, int ringCapacity) {
+  StatsUpdate update(bridgeStats.configSequence);
+  bridgeStats.sampleRate.store(rate, std::memory_order_relaxed);
+  bridgeStats.periodFrames.store(period, std::memory_order_relaxed);
+  bridgeStats.bufferFrames.store(bufferSize, std::memory_order_relaxed);
+  bridgeStats.ringCapacity.store(ringCapacity, std::memory_order_relaxed);
+}
+
+static void publishCaptureStats(int overruns, int xruns) {
+  StatsUpdate update(bridgeStats.captureSequence);
+  bridgeStats.overruns.store(overruns, std::memory_order_relaxed);
+  bridgeStats.xruns.store(xruns, std::memory_order_relaxed);
+  bridgeStats.captureCpuMs.store(threadCpuMillis(), std::memory_order_relaxed);
+  publishThreadScheduling(AudioThreadRole::Capture);
+}
+
+static void publishLatencyStats(LatencyAccountant &latency) {
+  LatencyAccountant::Window window;
+  if (!latency.takeWindow(&window))
+    return;
+  StatsUpdate update(bridgeStats.latencySequence);
+  bridgeStats.latencyMs.store(window.currentMs, std::memory_order_relaxed);
+  bridgeStats.latencyMinMs.store(window.minMs, std::memory_order_relaxed);
+  bridgeStats.latencyAvgMs.store(window.avgMs, std::memory_order_relaxed);
+  bridgeStats.latencyMaxMs.store(window.maxMs, std::memory_order_relaxed);
+  bridgeStats.captureDelayFrames.store(latency.captureDelay(), std::memory_order_relaxed);
+  bridgeStats.engineQueuedFrames.store((int32_t)latency.engineFrames(),
+                                       std::memory_order_relaxed);
+}
 
 // Define Globals
 std::atomic<bool> isRunning{false};
 std::atomic<bool> isFinished{true};
 std::atomic<bool> isSpeakerMuted{false};
 std::atomic<bool> isMicMuted{false};
+std::atomic<bool> isRateAdaptationEnabled{false};
+std::atomic<bool> isCpuPinningEnabled{false};
+std::atomic<bool> isSingleThreadEnabled{false};
+std::atomic<int> captureHintPeriodFrames{0};
+std::atomic<int> captureHintPeriodCount{0};
+std::atomic<bool> isAdaptiveLatencyEnabled{false};
+std::atomic<int> latencyTargetHintFrames{0};
 std::thread bridgeThread;
 
-// --- Capture Thread ---
-// Report actual period size to bridge
-void captureLoop(unsigned int card, unsigned int device, RingBuffer *rb,
-                 int *out_period_size, int requested_period_size,
-                 int requested_rate) {
-  setHighPriority();
-  struct pcm_config config;
-  memset(&config, 0, sizeof(config));
-  config.channels = 2;
-  config.period_count = 4;
-  config.format = PCM_FORMAT_S16_LE;
+namespace {
+class NullAudioBackend : public AudioBackend {
+public:
+  AudioEngine *createOutput(int engineType) override {
+    if (engineType == 3) {
+      LOGD("[Native] Using Null Engine (timer callback)");
+      return new NullPullAudioEngine();
+    }
+    LOGD("[Native] Using Null Engine (paced)");
+    return new NullAudioEngine(true);
+  }
+};
 
-  struct pcm *pcm = nullptr;
-
-  unsigned int rate = (unsigned int)requested_rate;
-  if (rate == 0)
-    rate = 48000; // Fallback
-
-  // Configs: Try provided period size, or Smart Auto
-  std::vector<size_t> periods;
-  std::vector<unsigned int> period_counts;
-  // Expanded list to hit exact "/4" targets for common buffer sizes (30ms=1440->360, 20ms=960->240, etc)
-  std::vector<size_t> candidates = {4096, 2048, 1024, 960, 512, 480, 360, 256, 240, 192, 128, 120, 96, 64};
-  // Larger buffer presets can tolerate/benefit from a less aggressive ALSA period layout.
-  double buffer_ms = (rb->capacity() / 4.0) * 1000.0 / (rate > 0 ? rate : 48000);
-  if (buffer_ms >= 60.0) {
-    period_counts = {6, 8, 4};
-  } else {
-    period_counts = {4, 6, 8};
+NullAudioBackend nullBackend;
+std::atomic<AudioBackend *> audioBackend{&nullBackend};
+} // namespace
+
+void setAudioBackend(AudioBackend *backend) {
+  audioBackend = backend ? backend : &nullBackend;
+}
+
+static std::mutex finishedMutex;
+static std::condition_variable finishedCond;
+
+static void markBridgeFinished() {
+  {
+    std::lock_guard<std::mutex> lock(finishedMutex);
+    isFinished = true;
   }
+  finishedCond.notify_all();
+}
 
-  if (requested_period_size > 0) {
-    periods.push_back((size_t)requested_period_size);
-  } else {
-    // Smart Auto: Target ~4 periods per buffer for stability/latency balance.
-    size_t buffer_frames = rb->capacity() / 4; // 16-bit stereo = 4 bytes/frame
-    size_t target_period = buffer_frames / 4;
-
-    // Find best match (largest size <= target)
-    size_t best_match = 64; // Default to smallest
-    for (size_t c : candidates) {
-        if (c <= target_period) {
-            best_match = c;
-            break; // Found largest since candidates are desc
-        }
+bool waitForBridgeFinished(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(finishedMutex);
+  return finishedCond.wait_for(lock, timeout, [] { return isFinished.load(); });
+}
+
+// Read exactly `frames` from the PCM into `dst`. Same contract as
+// pcm_read(): 0 on success, negative on failure.
+static int readExact(struct pcm *pcm, BridgeFrame *dst, size_t frames) {
+  int res = pcm_readi(pcm, dst, (unsigned int)frames);
+  if (res < 0)
+    return res;
+  return ((unsigned int)res == frames) ? 0 : -EIO;
+}
+
+// Open the gadget capture PCM, preferring mmap access so periods can be
+// copied from the DMA area straight into the ring. Falls back to read()
+// access when the driver rejects MMAP_INTERLEAVED. Timestamps use
+// CLOCK_MONOTONIC so they compare directly with the output engine's.
+static struct pcm *openCapturePcm(unsigned int card, unsigned int device,
+                                  const struct pcm_config *config,
+                                  bool *use_mmap) {
+  struct pcm *pcm = pcm_open(card, device, PCM_IN | PCM_MMAP | PCM_MONOTONIC, config);
+  if (pcm && pcm_is_ready(pcm)) {
+    // Nothing implicitly starts an mmap capture stream.
+    if (pcm_start(pcm) == 0) {
+      *use_mmap = true;
+      return pcm;
     }
+  }
+  if (pcm)
+    pcm_close(pcm);
+  *use_mmap = false;
+  return pcm_open(card, device, PCM_IN | PCM_MONOTONIC, config);
+}
+
+// One period layout to try on the capture PCM.
+struct CaptureLayout {
+  size_t periodFrames;
+  unsigned int periodCount;
+
+  bool operator==(const CaptureLayout &o) const {
+    return periodFrames == o.periodFrames && periodCount == o.periodCount;
+  }
+};
+
+// Drop layouts outside the ranges the gadget driver advertises, so the first
+// pcm_open() normally succeeds. The list is left alone when the driver cannot
+// be queried or nothing would be left.
+static void filterByHwParams(unsigned int card, unsigned int device, unsigned int rate,
+                             std::vector<CaptureLayout> *layouts) {
+  struct pcm_params *params = pcm_params_get(card, device, PCM_IN);
+  if (!params) {
+    LOGE("[Native] Capture hw params unavailable, trying every layout");
+    return;
+  }
+  unsigned int periodMin = pcm_params_get_min(params, PCM_PARAM_PERIOD_SIZE);
+  unsigned int periodMax = pcm_params_get_max(params, PCM_PARAM_PERIOD_SIZE);
+  unsigned int countMin = pcm_params_get_min(params, PCM_PARAM_PERIODS);
+  unsigned int countMax = pcm_params_get_max(params, PCM_PARAM_PERIODS);
+  unsigned int bufferMin = pcm_params_get_min(params, PCM_PARAM_BUFFER_SIZE);
+  unsigned int bufferMax = pcm_params_get_max(params, PCM_PARAM_BUFFER_SIZE);
+  unsigned int rateMin = pcm_params_get_min(params, PCM_PARAM_RATE);
+  unsigned int rateMax = pcm_params_get_max(params, PCM_PARAM_RATE);
+  pcm_params_free(params);
+
+  LOGD("[Native] Capture hw limits: period %u-%u, count %u-%u, buffer %u-%u, rate %u-%u",
+       periodMin, periodMax, countMin, countMax, bufferMin, bufferMax, rateMin, rateMax);
+  if (rate < rateMin || rate > rateMax) {
+    // The gadget rate is fixed by configfs; opening will fail until it matches.
+    LOGE("[Native] Requested rate %u is outside the gadget's %u-%u Hz", rate, rateMin,
+         rateMax);
+  }
+
+  std::vector<CaptureLayout> legal;
+  for (const CaptureLayout &layout : *layouts) {
+    size_t buffer = layout.periodFrames * layout.periodCount;
+    if (layout.periodFrames >= periodMin && layout.periodFrames <= periodMax &&
+        layout.periodCount >= countMin && layout.periodCount <= countMax &&
+        buffer >= bufferMin && buffer <= bufferMax) {
+      legal.push_back(layout);
+    }
+  }
+  if (!legal.empty())
+    layouts->swap(legal);
+}
 
-    periods.push_back(best_match);
+// Move everything the gadget has captured from its mmap area into the ring,
+// one contiguous DMA region at a time. Frames that do not fit the ring are
+// dropped but still committed so the PCM keeps running. 0 on success,
+// negative on failure.
+static int captureMmap(struct pcm *pcm, BridgeRingBuffer *rb,
+                       size_t *captured, size_t *dropped) {
+  *captured = 0;
+  *dropped = 0;
+  while (true) {
+    void *areas = nullptr;
+    unsigned int offset = 0;
+    unsigned int frames = UINT_MAX;
+    pcm_mmap_begin(pcm, &areas, &offset, &frames);
+    if (frames == 0)
+      break;
 
-    // Add others as fallback (skip duplicates)
-    for (size_t c : candidates) {
-        if (c != best_match) periods.push_back(c);
+    const BridgeFrame *src = static_cast<const BridgeFrame *>(areas) + offset;
+    BridgeRingBuffer::Regions span = rb->beginWrite(frames);
+    if (span.first.frames > 0) {
+      memcpy(span.first.data, src, span.first.bytes());
+    }
+    if (span.second.frames > 0) {
+      memcpy(span.second.data, src + span.first.frames, span.second.bytes());
     }
+    rb->commitWrite(span.frames());
+
+    int res = pcm_mmap_commit(pcm, offset, frames);
+    if (res < 0)
+      return res;
+    *captured += frames;
+    *dropped += frames - span.frames();
   }
+  return 0;
+}
+
+// --- Capture Side ---
+// Owns the gadget capture PCM and everything the capture path tracks. The
+// threaded mode drives it from captureLoop(); the single-thread mode calls
+// step() from the bridge loop whenever the PCM fd polls readable.
+class CaptureStream {
+public:
+  CaptureStream(BridgeRingBuffer *rb, DriftEstimator *drift, LatencyAccountant *latency,
+                HostActivityMonitor *hostMonitor)
+      : rb_(rb), drift_(drift), latency_(latency), hostMonitor_(hostMonitor) {}
+  ~CaptureStream() { close(); }
+
+  CaptureStream(const CaptureStream &) = delete;
+  CaptureStream &operator=(const CaptureStream &) = delete;
+
+  // Try period layouts until the gadget accepts one, retrying while the host
+  // has not configured the function yet. Layouts the driver rules out are
+  // never tried, and `hint` (the last layout that worked for this request)
+  // goes first. Clears isRunning on failure.
+  bool open(unsigned int card, unsigned int device, int requested_period_size,
+            int requested_rate, CaptureLayout hint) {
+    struct pcm_config config;
+    memset(&config, 0, sizeof(config));
+    config.channels = BridgeFrame::kChannels;
+    config.period_count = 4;
+    config.format = pcmFormatFor<BridgeFrame::SampleType>();
+
+    unsigned int rate = (unsigned int)requested_rate;
+    if (rate == 0)
+      rate = 48000; // Fallback
+
+    // Configs: Try provided period size, or Smart Auto
+    std::vector<size_t> periods;
+    std::vector<unsigned int> period_counts;
+    std::vector<CaptureLayout> layouts;
+    // Expanded list to hit exact "/4" targets for common buffer sizes (30ms=1440->360, 20ms=960->240, etc)
+    std::vector<size_t> candidates = {4096, 2048, 1024, 960, 512, 480, 360, 256, 240, 192, 128, 120, 96, 64};
+    // Larger buffer presets can tolerate/benefit from a less aggressive ALSA period layout.
+    double buffer_ms = (double)rb_->capacity() * 1000.0 / (rate > 0 ? rate : 48000);
+    if (buffer_ms >= 60.0) {
+      period_counts = {6, 8, 4};
+    } else {
+      period_counts = {4, 6, 8};
+    }
 
-  bool opened = false;
+    if (requested_period_size > 0) {
+      periods.push_back((size_t)requested_period_size);
+    } else {
+      // Smart Auto: Target ~4 periods per buffer for stability/latency balance.
+      size_t buffer_frames = rb_->capacity();
+      size_t target_period = buffer_frames / 4;
+
+      // Find best match (largest size <= target)
+      size_t best_match = 64; // Default to smallest
+      for (size_t c : candidates) {
+          if (c <= target_period) {
+              best_match = c;
+              break; // Found largest since candidates are desc
+          }
+      }
 
-  // Outer loop for retrying connection (waiting for host)
-  reportStateToJava(1); // 1 = CONNECTING (Searching/Retrying PCM)
-  for (int retry = 0; retry < 20 && isRunning; retry++) {
-    config.rate = rate;
+      periods.push_back(best_match);
+
+      // Add others as fallback (skip duplicates)
+      for (size_t c : candidates) {
+          if (c != best_match) periods.push_back(c);
+      }
+    }
     for (size_t p_size : periods) {
-      for (unsigned int p_count : period_counts) {
-        // Ensure period fits in ring buffer (bytes)
-        if (p_size * 4 > rb->capacity()) {
-          continue;
-        }
-        config.period_size = p_size;
-        config.period_count = p_count;
+      // Ensure period fits in ring buffer
+      if (p_size > rb_->capacity())
+        continue;
+      for (unsigned int p_count : period_counts)
+        layouts.push_back({p_size, p_count});
+    }
+    filterByHwParams(card, device, rate, &layouts);
+    if (hint.periodFrames > 0 && hint.periodFrames <= rb_->capacity() &&
+        (requested_period_size <= 0 || hint.periodFrames == (size_t)requested_period_size)) {
+      layouts.erase(std::remove(layouts.begin(), layouts.end(), hint), layouts.end());
+      layouts.insert(layouts.begin(), hint);
+    }
+
+    bool opened = false;
+    int attempts = 0;
+
+    // Outer loop for retrying connection (waiting for host)
+    reportStateToJava(1); // 1 = CONNECTING (Searching/Retrying PCM)
+    for (int retry = 0; retry < 20 && isRunning; retry++) {
+      config.rate = rate;
+      for (const CaptureLayout &layout : layouts) {
+        config.period_size = layout.periodFrames;
+        config.period_count = layout.periodCount;
 
-        pcm = pcm_open(card, device, PCM_IN, &config);
+        attempts++;
+        pcm_ = openCapturePcm(card, device, &config, &use_mmap_);
 
-        if (pcm && pcm_is_ready(pcm)) {
+        if (pcm_ && pcm_is_ready(pcm_)) {
           opened = true;
-          if (out_period_size)
-            *out_period_size = (int)p_size;
           LOGD("[Native] PCM Device ready. Waiting for Host stream... (Rate: %u, "
-               "Period: %zu, Count: %u)",
-               rate, p_size, p_count);
+               "Period: %zu, Count: %u, Access: %s, Attempts: %d)",
+               rate, layout.periodFrames, layout.periodCount, use_mmap_ ? "mmap" : "read",
+               attempts);
           reportStateToJava(2); // 2 = WAITING (PCM Open, No Data)
+          if (!(layout == hint))
+            reportCaptureLayoutToJava((int)layout.periodFrames, (int)layout.periodCount);
           break;
         }
 
-        if (pcm) {
-          LOGE("[Native] Config %zu x %u failed: %s", p_size, p_count, pcm_get_error(pcm));
-          pcm_close(pcm);
-          pcm = nullptr;
+        if (pcm_) {
+          LOGE("[Native] Config %zu x %u failed: %s", layout.periodFrames, layout.periodCount,
+               pcm_get_error(pcm_));
+          pcm_close(pcm_);
+          pcm_ = nullptr;
         }
       }
+
       if (opened)
         break;
+
+      LOGE("[Native] All configs failed. Retrying in 1s...");
+      // The host opening its stream is the usual reason the next attempt
+      // works, so retry right away when that happens.
+      if (hostMonitor_->waitForChange(std::chrono::milliseconds(1000)))
+        break;
     }
 
-    if (opened)
-      break;
+    if (!opened || !isRunning) {
+      LOGE("[Native] Error: Failed to open PCM after retries.");
+      close();
+      isRunning = false;
+      return false;
+    }
 
-    LOGE("[Native] All configs failed. Retrying in 1s...");
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    period_frames_ = config.period_size;
+    rate_ = config.rate;
+    haveLastCommit_ = false;
+    local_buf_.resize(period_frames_);
+    openAttempts_ = attempts;
+    openedNanos_.store(monotonicNanos(std::chrono::steady_clock::now()),
+                       std::memory_order_release);
+    lastDriftSample_ = std::chrono::steady_clock::now();
+    lastLatencySample_ = lastDriftSample_;
+    lastStatsPublish_ = lastDriftSample_;
+    return true;
   }
 
-  if (!opened || !isRunning) {
-    LOGE("[Native] Error: Failed to open PCM after retries.");
-    if (pcm) {
-      pcm_close(pcm);
-      pcm = nullptr;
+  void close() {
+    if (pcm_) {
+      pcm_close(pcm_);
+      pcm_ = nullptr;
     }
-    isRunning = false;
-    return;
   }
 
-  if (!isRunning)
-    return;
+  struct pcm *pcm() const { return pcm_; }
+  size_t periodFrames() const { return period_frames_; }
 
-  unsigned int chunk_bytes = pcm_frames_to_bytes(pcm, config.period_size);
-  std::vector<uint8_t> local_buf(chunk_bytes);
-  // LOGD("[Native] Capture loop running.");
+  // The host paused: its position no longer advances with time.
+  void idle() {
+    drift_->resetCapture();
+    haveLastCommit_ = false;
+  }
 
-  int readErrorCount = 0;
-  int overrunCount = 0;
-  while (isRunning) {
-    // Wait up to 100ms for data. This allows checking isRunning frequently.
-    int wait_res = pcm_wait(pcm, 100);
-    if (wait_res == 0) {
-      // Timeout, check isRunning again
-      continue;
+  // Longest wait between ring commits beyond one period since the last
+  // call, in frames. Readable from any thread.
+  size_t takeLateFrames() { return lateFrames_.exchange(0, std::memory_order_relaxed); }
+
+  // Startup milestones (steady clock), 0 until reached. Readable from any
+  // thread; openAttempts() is valid once openedNanos() is non-zero.
+  int64_t openedNanos() const { return openedNanos_.load(std::memory_order_acquire); }
+  int64_t firstSampleNanos() const { return firstSampleNanos_.load(std::memory_order_acquire); }
+  int openAttempts() const { return openAttempts_; }
+
+  // Transfer what the PCM has after a wait reported `wait_res` (> 0 ready,
+  // < 0 error, as pcm_wait()). Returns false once capture has failed for
+  // good.
+  bool step(int wait_res) {
+    int res;
+    size_t captured = period_frames_;
+    size_t dropped = 0;
+    if (use_mmap_) {
+      // pcm_wait reports XRUN/disconnect itself; there is no read to fail.
+      res = (wait_res < 0) ? wait_res : captureMmap(pcm_, rb_, &captured, &dropped);
+    } else {
+      // Read straight into the ring when a whole period fits; only an
+      // overrun goes through local_buf so the tail of the period can be
+      // dropped.
+      BridgeRingBuffer::Regions span = rb_->beginWrite(period_frames_);
+      if (span.frames() == period_frames_) {
+        res = readExact(pcm_, span.first.data, span.first.frames);
+        if (res == 0 && span.second.frames > 0)
+          res = readExact(pcm_, span.second.data, span.second.frames);
+        if (res == 0)
+          rb_->commitWrite(period_frames_);
+      } else {
+        res = readExact(pcm_, local_buf_.data(), period_frames_);
+        if (res == 0)
+          dropped = period_frames_ - rb_->write(local_buf_.data(), period_frames_);
+      }
     }
-
-    int res = pcm_read(pcm, local_buf.data(), chunk_bytes);
     if (res == 0) {
-      size_t written = rb->write(local_buf.data(), chunk_bytes);
-      if (written < chunk_bytes) {
-        size_t dropped = chunk_bytes - written;
-        if (overrunCount++ % 50 == 0) {
-          LOGE("[Native] RING BUFFER OVERRUN! (wrote %zu/%u, dropped %zu bytes)",
-               written, chunk_bytes, dropped);
+      if (dropped > 0) {
+        if (overrunCount_++ % 50 == 0) {
+          LOGE("[Native] RING BUFFER OVERRUN! (wrote %zu/%zu, dropped %zu frames)",
+               captured - dropped, captured, dropped);
         }
       }
       // Reset error count on success
-      readErrorCount = 0;
-    } else {
-      // Failed read
-      if (errno == EAGAIN) {
-        // No data available yet. Wait slightly and check isRunning.
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
-        continue;
+      readErrorCount_ = 0;
+
+      auto now = std::chrono::steady_clock::now();
+      if (pcmFrames_ == 0 && captured > 0)
+        firstSampleNanos_.store(monotonicNanos(now), std::memory_order_release);
+      noteCommit(now);
+      pcmFrames_ += captured;
+      if (now - lastDriftSample_ >= kDriftSampleInterval) {
+        unsigned int avail = 0;
+        struct timespec tstamp;
+        if (pcm_get_htimestamp(pcm_, &avail, &tstamp) == 0) {
+          drift_->addCaptureSample(pcmFrames_ + avail, toNanos(tstamp));
+        }
+        lastDriftSample_ = now;
+      }
+      if (now - lastLatencySample_ >= kLatencySampleInterval) {
+        // Frames the host already delivered that are still in the PCM.
+        long delay = pcm_get_delay(pcm_);
+        if (delay < 0) {
+          unsigned int avail = 0;
+          struct timespec tstamp;
+          if (pcm_get_htimestamp(pcm_, &avail, &tstamp) == 0)
+            delay = (long)avail;
+        }
+        latency_->setCaptureDelay(delay);
+        lastLatencySample_ = now;
+      }
+      if (now - lastStatsPublish_ >= kStatsPublishInterval) {
+        publishCaptureStats(overrunCount_, xrunCount_);
+        lastStatsPublish_ = now;
       }
+      return true;
+    }
 
-      readErrorCount++;
+    // Failed read
+    if (!use_mmap_ && errno == EAGAIN) {
+      // No data available yet. Wait slightly unless stopping.
+      bridgeStop.waitFor(std::chrono::milliseconds(5));
+      return true;
+    }
 
-      const char *err_msg = pcm_get_error(pcm);
+    readErrorCount_++;
 
-      // Log occasionally to avoid spam
-      if (readErrorCount % 20 == 0) {
-        LOGE("[Native] PCM READ FAILING! (Consecutive: %d, Error: %s)",
-             readErrorCount, err_msg);
-      }
+    const char *err_msg = pcm_get_error(pcm_);
 
-      // FATAL ERROR CHECK
-      // If we fail > 50 times consecutively (approx 50 * 20ms = 1 sec), assume
-      // device is dead. Also check for explicit disconnect errors if possible
-      // (TinyALSA mostly generic, but -ENODEV/EIO common) We rely on count
-      // mainly.
-      if (readErrorCount > 50) {
-        LOGE("[Native] Too many errors. Assuming USB Disconnect.");
-        reportErrorToJava("Capture Failed");
-        isRunning = false;
-        break;
-      }
+    // Log occasionally to avoid spam
+    if (readErrorCount_ % 20 == 0) {
+      LOGE("[Native] PCM READ FAILING! (Consecutive: %d, Error: %s)",
+           readErrorCount_, err_msg);
+    }
 
-      // Attempt recovery logic
-      // If broken pipe (XRUN), prepare might fix it. If physical disconnect,
-      // prepare will fail or read will fail again.
-      pcm_prepare(pcm);
+    // FATAL ERROR CHECK
+    // If we fail > 50 times consecutively (approx 50 * 20ms = 1 sec), assume
+    // device is dead. Also check for explicit disconnect errors if possible
+    // (TinyALSA mostly generic, but -ENODEV/EIO common) We rely on count
+    // mainly.
+    if (readErrorCount_ > 50) {
+      LOGE("[Native] Too many errors. Assuming USB Disconnect.");
+      reportErrorToJava("Capture Failed");
+      isRunning = false;
+      return false;
     }
+
+    // Attempt recovery logic
+    // If broken pipe (XRUN), prepare might fix it. If physical disconnect,
+    // prepare will fail or read will fail again. An mmap stream also needs
+    // an explicit restart.
+    drift_->resetCapture();
+    publishCaptureStats(overrunCount_, ++xrunCount_);
+    pcm_prepare(pcm_);
+    if (use_mmap_)
+      pcm_start(pcm_);
+    return true;
   }
-  if (pcm) {
-    pcm_close(pcm);
-    pcm = nullptr;
+
+private:
+  // The ring goes without input from one commit to the next; anything past
+  // a period is host or scheduling jitter the fill has to cover.
+  void noteCommit(std::chrono::steady_clock::time_point now) {
+    if (haveLastCommit_ && now - lastCommit_ < kMaxCaptureGap) {
+      int64_t waited = std::chrono::duration_cast<std::chrono::microseconds>(now - lastCommit_)
+                           .count() * (int64_t)rate_ / 1000000;
+      if (waited > (int64_t)period_frames_) {
+        size_t late = (size_t)(waited - (int64_t)period_frames_);
+        size_t seen = lateFrames_.load(std::memory_order_relaxed);
+        while (late > seen &&
+               !lateFrames_.compare_exchange_weak(seen, late, std::memory_order_relaxed)) {
+        }
+      }
+    }
+    lastCommit_ = now;
+    haveLastCommit_ = true;
   }
+
+  BridgeRingBuffer *rb_;
+  DriftEstimator *drift_;
+  LatencyAccountant *latency_;
+  HostActivityMonitor *hostMonitor_;
+
+  struct pcm *pcm_ = nullptr;
+  bool use_mmap_ = false;
+  size_t period_frames_ = 0;
+  std::vector<BridgeFrame> local_buf_;
+
+  int readErrorCount_ = 0;
+  int overrunCount_ = 0;
+  int xrunCount_ = 0;
+  // Everything taken out of the PCM, including dropped frames; with the
+  // hardware avail this is the host's position for the drift estimator.
+  int64_t pcmFrames_ = 0;
+  std::chrono::steady_clock::time_point lastDriftSample_;
+  std::chrono::steady_clock::time_point lastLatencySample_;
+  std::chrono::steady_clock::time_point lastStatsPublish_;
+  unsigned int rate_ = 48000;
+  std::chrono::steady_clock::time_point lastCommit_;
+  bool haveLastCommit_ = false;
+  std::atomic<size_t> lateFrames_{0};
+
+  int openAttempts_ = 0;
+  std::atomic<int64_t> openedNanos_{0};
+  std::atomic<int64_t> firstSampleNanos_{0};
+};
+
+// --- Capture Thread ---
+// Report actual period size to bridge
+void captureLoop(CaptureStream *capture, unsigned int card, unsigned int device,
+                 int *out_period_size, int requested_period_size,
+                 int requested_rate, CaptureLayout hint) {
+  promoteAudioThread(AudioThreadRole::Capture);
+  publishCaptureStats(0, 0);
+  if (!capture->open(card, device, requested_period_size, requested_rate, hint))
+    return;
+  if (out_period_size)
+    *out_period_size = (int)capture->periodFrames();
+
+  struct pollfd fds[2] = {
+      {pcm_get_poll_fd(capture->pcm()), POLLIN, 0},
+      {bridgeStop.fd(), POLLIN, 0},
+  };
+  while (isRunning) {
+    // Sleep until the host sends a period or the bridge is stopped.
+    int ready = poll(fds, 2, (int)kRingWaitTimeout.count());
+    if (ready < 0)
+      continue;
+    if (fds[1].revents & POLLIN)
+      break;
+    if (ready == 0) {
+      // Host silent for the whole timeout.
+      capture->idle();
+      continue;
+    }
+    int wait_res = captureWaitResult(capture->pcm(), fds[0].revents);
+    if (wait_res != 0 && !capture->step(wait_res))
+      break;
+  }
+  capture->close();
   LOGD("[Native] Host closed device (Capture stopped).");
 }
 
@@ -209,7 +686,7 @@ void captureLoop(unsigned int card, unsigned int device, RingBuffer *rb,
 // Reads from Android Mic (InputEngine), writes to USB Gadget (PCM_OUT)
 void playbackLoop(unsigned int card, unsigned int device, int sampleRate,
                   int engineType, int micSource) {
-  setHighPriority();
+  promoteAudioThread(AudioThreadRole::Mic);
   LOGD("[Native] Starting playback loop (Mic -> Gadget)...");
 
   struct pcm_config config;
@@ -220,11 +697,11 @@ void playbackLoop(unsigned int card, unsigned int device, int sampleRate,
   config.period_count = 4;
   config.format = PCM_FORMAT_S16_LE;
 
-  std::unique_ptr<AudioInputEngine> inputEngine;
-  // Currently only supporting AAudio for Input for cleanliness, or fallback?
-  // Use AAudio for input.
-  inputEngine = std::make_unique<AAudioInputEngine>();
-  inputEngine->setInputPreset(micSource);
+  std::unique_ptr<AudioInputEngine> inputEngine(audioBackend.load()->createInput(micSource));
+  if (!inputEngine) {
+    LOGE("[Native] No Mic Input Engine on this platform");
+    return;
+  }
 
   if (!inputEngine->open(config.rate, 2)) {
     LOGE("[Native] Failed to open Mic Input Engine");
@@ -249,7 +726,16 @@ void playbackLoop(unsigned int card, unsigned int device, int sampleRate,
 
   LOGD("[Native] Mic -> Gadget streaming active.");
 
+  // Ends a pending mic read on stop; gone before the engine is closed.
+  auto stopWaker =
+      std::make_unique<StopWaker>(bridgeStop, [&inputEngine] { inputEngine->interrupt(); });
+  auto lastStatsPublish = std::chrono::steady_clock::now();
   while (isRunning) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastStatsPublish >= kStatsPublishInterval) {
+      publishThreadScheduling(AudioThreadRole::Mic);
+      lastStatsPublish = now;
+    }
     size_t readBytes = inputEngine->read(buffer.data(), buffer_bytes);
     if (readBytes > 0) {
       if (isMicMuted) {
@@ -262,9 +748,10 @@ void playbackLoop(unsigned int card, unsigned int device, int sampleRate,
         // pcm_prepare(pcm); // might help?
       }
     } else {
-      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      bridgeStop.waitFor(std::chrono::milliseconds(5));
     }
   }
+  stopWaker.reset();
 
   pcm_close(pcm);
   inputEngine->stop();
@@ -276,7 +763,8 @@ void playbackLoop(unsigned int card, unsigned int device, int sampleRate,
 void bridgeTask(int card, int device, int bufferSizeFrames,
                 int periodSizeFrames, int engineType, int sampleRate,
                 int activeDirections, int micSource) {
-  setHighPriority();
+  auto bridgeStart = std::chrono::steady_clock::now();
+  promoteAudioThread(AudioThreadRole::Output);
 
   bool enableSpeaker = (activeDirections & 1) != 0;
   bool enableMic = (activeDirections & 2) != 0;
@@ -297,277 +785,614 @@ void bridgeTask(int card, int device, int bufferSizeFrames,
       micThread.join();
     }
     reportStateToJava(0);
-    isFinished = true;
-    if (javaVM)
-      javaVM->DetachCurrentThread();
+    markBridgeFinished();
     return;
   }
 
   // Speaker Logic
 
-  // Use provided buffer size (Minimum 480 to avoid issues)
-  size_t deep_buffer_frames = (size_t)std::max(480, bufferSizeFrames);
-  // Keep a small internal guard margin to absorb scheduler/USB jitter on
-  // older devices without changing the user-visible buffer setting.
-  size_t jitter_guard_frames = std::max<size_t>(240, deep_buffer_frames / 4);
-  size_t effective_buffer_frames = deep_buffer_frames + jitter_guard_frames;
+  // Use provided buffer size (Minimum 480 to avoid issues) plus the guard.
+  const BufferPlan plan = BufferPlan::forRequest(bufferSizeFrames, sampleRate);
+  size_t deep_buffer_frames = plan.deepFrames;
+  size_t jitter_guard_frames = plan.guardFrames;
+  size_t effective_buffer_frames = plan.ringFrames();
   LOGD("[Native] Starting Speaker Bridge. Buffer: %zu frames, PeriodReq: %d, "
        "Engine: %d, Rate: %d, Guard: +%zu",
        deep_buffer_frames, periodSizeFrames, engineType, sampleRate,
        jitter_guard_frames);
 
-  size_t bytes_per_frame = 4; // 16-bit stereo
-  size_t rb_size = effective_buffer_frames * bytes_per_frame;
-  RingBuffer rb(rb_size);
-
+  // Mirrored storage keeps every ring region contiguous for the engines.
+  BridgeRingBuffer rb(effective_buffer_frames, true);
+  LOGD("[Native] Ring buffer: %zu frames x %zu bytes (%s storage)", rb.capacity(),
+       sizeof(BridgeFrame), rb.isMirrored() ? "mirrored" : "heap");
+
+  DriftEstimator drift;
+  // Clear the previous session's numbers; config is filled in after pre-roll.
+  publishConfigStats(0, 0, 0, 0);
+  {
+    StatsUpdate update(bridgeStats.latencySequence);
+    bridgeStats.latencyMs.store(0.0f, std::memory_order_relaxed);
+    bridgeStats.latencyMinMs.store(0.0f, std::memory_order_relaxed);
+    bridgeStats.latencyAvgMs.store(0.0f, std::memory_order_relaxed);
+    bridgeStats.latencyMaxMs.store(0.0f, std::memory_order_relaxed);
+  }
+  OutputStatsPublisher outputStats;
+  outputStats.publish(0, 0, 0, drift.ppm());
   int actual_period_size = 0;
-  std::thread c_thread(captureLoop, card, device, &rb, &actual_period_size,
-                       periodSizeFrames, sampleRate);
+  LatencyAccountant latency(sampleRate);
+  // Host open/close and rate events; without them the bridge falls back to
+  // the 1 s data timeout for idle detection.
+  HostActivityMonitor hostMonitor;
+  if (!hostMonitor.start(card, sampleRate > 0 ? sampleRate : 48000))
+    LOGD("[Native] No host rate control on card %d, using data timeouts", card);
+  CaptureStream capture(&rb, &drift, &latency, &hostMonitor);
+  CaptureLayout layoutHint = {(size_t)std::max(0, captureHintPeriodFrames.load()),
+                              (unsigned int)std::max(0, captureHintPeriodCount.load())};
 
   int32_t rate = (sampleRate > 0) ? sampleRate : 48000;
 
   // Select Engine
-  AudioEngine *engine = nullptr;
-  if (engineType == 1) {
-    engine = new OpenSLEngine();
-    LOGD("[Native] Using OpenSL ES Engine");
-  } else if (engineType == 2) {
-    engine = new JavaAudioTrackEngine();
-    LOGD("[Native] Using Legacy AudioTrack Engine");
+  AudioEngine *engine = audioBackend.load()->createOutput(engineType);
+
+  // Callback engines drain the ring from their own real-time thread; this
+  // thread then only supervises.
+  RingPullSource<BridgeFrame> pullSource(&rb);
+  bool pullMode = engine->setPullSource(&pullSource);
+
+  // Single-thread mode moves capture onto this thread: one poll over the
+  // capture PCM, the stop eventfd and a housekeeping timer replaces the
+  // cross-core handoff through the ring. Callback engines already have their
+  // own data thread, so it only applies to push engines.
+  bool singleThread = isSingleThreadEnabled && !pullMode;
+  std::thread c_thread;
+  int timerFd = -1;
+  auto lastCaptureTime = std::chrono::steady_clock::now();
+  if (singleThread) {
+    LOGD("[Native] Single-thread bridge: capture and output on one thread");
+    publishCaptureStats(0, 0);
+    if (capture.open(card, device, periodSizeFrames, sampleRate, layoutHint))
+      actual_period_size = (int)capture.periodFrames();
+
+    // Ticks while the host is silent so idle detection and stats still run.
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (timerFd >= 0) {
+      struct itimerspec tick;
+      memset(&tick, 0, sizeof(tick));
+      tick.it_interval.tv_nsec = 20 * 1000000L;
+      tick.it_value = tick.it_interval;
+      timerfd_settime(timerFd, 0, &tick, nullptr);
+    }
   } else {
-    engine = new AAudioEngine();
-    LOGD("[Native] Using AAudio Engine");
+    c_thread = std::thread(captureLoop, &capture, card, device, &actual_period_size,
+                           periodSizeFrames, sampleRate, layoutHint);
   }
 
-  if (!engine->open(rate, 2)) {
+  // Single-thread mode: wait up to `timeoutMs` for the next capture period,
+  // a timer tick or stop, and move at most one period into the ring.
+  // Returns false once capture has failed for good.
+  auto pumpCapture = [&](int timeoutMs) -> bool {
+    struct pcm *pcm = capture.pcm();
+    if (!pcm)
+      return false;
+    struct pollfd fds[3] = {
+        {pcm_get_poll_fd(pcm), POLLIN, 0},
+        {bridgeStop.fd(), POLLIN, 0},
+        {timerFd, POLLIN, 0},
+    };
+    if (poll(fds, 3, timeoutMs) < 0)
+      return true;
+    if (fds[2].revents & POLLIN) {
+      uint64_t ticks;
+      (void)read(timerFd, &ticks, sizeof(ticks));
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (fds[0].revents & (POLLIN | POLLERR | POLLNVAL)) {
+      lastCaptureTime = now;
+      int wait_res = captureWaitResult(pcm, fds[0].revents);
+      return wait_res == 0 || capture.step(wait_res);
+    }
+    if (now - lastCaptureTime > kRingWaitTimeout) {
+      // Same as a pcm_wait() timeout in the capture thread.
+      capture.idle();
+      lastCaptureTime = now;
+    }
+    return true;
+  };
+
+  if (!engine->open(rate, BridgeFrame::kChannels)) {
     LOGE("[Native] Error: Failed to open Audio Engine.");
     isRunning = false;
+    bridgeStop.raise();
     delete engine;
     if (c_thread.joinable())
       c_thread.join();
+    if (timerFd >= 0)
+      close(timerFd);
     if (micThread.joinable())
       micThread.join();
+    reportStateToJava(0);
+    markBridgeFinished();
     return;
   }
 
-  engine->start();
-
-  // Pre-roll: wait for a stable initial fill before playback starts.
-  // Use a slightly higher target on larger buffers for older-device stability.
-  size_t configured_ms = (size_t)((deep_buffer_frames * 1000) / rate);
-  size_t target_preroll_ms = 50;
-  if (configured_ms >= 80) {
-    target_preroll_ms = 65;
-  } else if (configured_ms >= 60) {
-    target_preroll_ms = 55;
-  }
-  // Cap at 50% of ring capacity to avoid deadlock on tiny buffers.
-  size_t target_preroll_bytes =
-      (size_t)(rate * target_preroll_ms / 1000) * bytes_per_frame;
-  if (target_preroll_bytes > rb.capacity() / 2) {
-      target_preroll_bytes = rb.capacity() / 2;
+  // Stop also has to end futex waits on the ring and a write blocked in the
+  // engine. Released before the engine is deleted.
+  auto stopWaker = std::make_unique<StopWaker>(bridgeStop, [&rb, engine] {
+    rb.interruptWaits();
+    engine->interrupt();
+  });
+
+  // A push engine is started now so its own buffer fills during pre-roll;
+  // a callback engine would only render silence until the ring is primed.
+  if (!pullMode)
+    engine->start();
+
+  // Pre-roll: wait for a stable initial fill before playback starts. In
+  // adaptive latency mode the tuner picks that fill instead of the plan, and
+  // keeps moving it while the bridge runs.
+  bool adaptiveLatency = isAdaptiveLatencyEnabled;
+  const LatencyTuner::Bounds latencyBounds = LatencyTuner::boundsFor(plan, rate);
+  LatencyTuner tuner(latencyBounds,
+                     (size_t)std::max(0, latencyTargetHintFrames.load()), rate,
+                     std::chrono::steady_clock::now());
+  size_t target_preroll_frames = plan.prerollFrames;
+  if (adaptiveLatency) {
+    // The floor depends on the capture period, which is only known once the
+    // first one has reached the ring: capture commits whole periods, so less
+    // than two of them always runs dry. Pre-roll to the raised target.
+    if (singleThread) {
+      while (isRunning && rb.available() == 0) {
+        if (!pumpCapture((int)kRingWaitTimeout.count()))
+          break;
+      }
+    }
+    while (isRunning && !rb.waitForReadable(1, kRingWaitTimeout)) {
+      // Timed out: loop only to re-check isRunning.
+    }
+    tuner.raiseFloor(2 * (size_t)std::max(0, actual_period_size));
+    // Lateness so far is startup, not steady-state jitter.
+    capture.takeLateFrames();
+    if (tuner.update(std::chrono::steady_clock::now()))
+      reportLatencyTargetToJava((int)tuner.targetFrames());
+    target_preroll_frames = tuner.targetFrames();
+    LOGD("[Native] Adaptive latency: target %zu frames (hint %d, ceiling %zu)",
+         target_preroll_frames, latencyTargetHintFrames.load(), latencyBounds.maxFrames);
   }
-  // Ensure at least 1 frame (avoid 0 waiting)
-  if (target_preroll_bytes == 0) target_preroll_bytes = bytes_per_frame;
 
-  LOGD("[Native] Pre-rolling (Target: %zu bytes)...", target_preroll_bytes);
+  LOGD("[Native] Pre-rolling (Target: %zu frames)...", target_preroll_frames);
+  if (singleThread) {
+    while (isRunning && rb.available() < target_preroll_frames) {
+      if (!pumpCapture((int)kRingWaitTimeout.count()))
+        break;
+    }
+  }
   while (isRunning &&
-         rb.available() < target_preroll_bytes) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+         !rb.waitForReadable(target_preroll_frames, kRingWaitTimeout)) {
+    // Timed out: loop only to re-check isRunning.
   }
+  if (pullMode)
+    engine->start();
   LOGD("[Native] Host opened device (Streaming started).");
-  reportStatsToJava(rate, actual_period_size, (int)deep_buffer_frames);
-
-  int32_t burstFrames = engine->getBurstFrames();
-  if (burstFrames <= 0)
-    burstFrames = 192; // Fallback
-  int32_t rawBurstFrames = burstFrames;
-
-  const char *backendName = "AAudio";
-  int32_t minTargetFrames = 120;
-  int32_t maxTargetFrames = 480;
-  size_t lowWaterDivisor = 4;
-  size_t highWaterDivisor = 2;
-  int emptySleepUs = 500;
-  if (engineType == 1) {
-    backendName = "OpenSL";
-    minTargetFrames = 96;
-    maxTargetFrames = 192;
-    lowWaterDivisor = 3;
-    highWaterDivisor = 2;
-    emptySleepUs = 500;
-  } else if (engineType == 2) {
-    backendName = "AudioTrack";
-    minTargetFrames = 120;
-    maxTargetFrames = 480;
-    lowWaterDivisor = 3;
-    highWaterDivisor = 2;
-    emptySleepUs = 400;
-  } else {
-    backendName = "AAudio";
-    minTargetFrames = 96;
-    maxTargetFrames = 240;
-    // Wider hysteresis for AAudio to avoid rapid normal/reduced oscillation.
-    lowWaterDivisor = 8;
-    highWaterDivisor = 2;
-    emptySleepUs = 250;
-  }
-
-  // Some devices report very large "burst" values for AAudio/AudioTrack.
-  // Clamp to sane ranges for bridge chunking so adaptive logic stays valid.
-  int32_t maxBurstFrames = 384;
-  if (engineType == 1) {
-    maxBurstFrames = 256;
-  } else if (engineType == 2) {
-    maxBurstFrames = 960;
-  } else {
-    maxBurstFrames = 384;
-  }
-  burstFrames = std::max<int32_t>(96, std::min<int32_t>(burstFrames, maxBurstFrames));
-  if (burstFrames != rawBurstFrames) {
-    LOGD("[Native] %s burst clamped: raw=%d, using=%d", backendName, rawBurstFrames,
-         burstFrames);
-  }
-
-  // Use a chunk close to the capture period when available.
-  // Backend-specific bounds: AAudio prefers smaller writes for stability on
-  // some older devices, AudioTrack can tolerate bigger chunks.
-  int32_t targetFrames = (actual_period_size > 0) ? actual_period_size : burstFrames;
-  int32_t boundedTarget =
-      std::max<int32_t>(minTargetFrames, std::min<int32_t>(targetFrames, maxTargetFrames));
-  int32_t chunkFrames = std::max(burstFrames, boundedTarget);
-  size_t chunkBytes = chunkFrames * bytes_per_frame;
-  int32_t reducedChunkFrames = std::max<int32_t>(96, chunkFrames / 2);
-  if (engineType == 1) {
-    // OpenSL queueing is less predictable with tiny buffers.
-    reducedChunkFrames = std::max<int32_t>(burstFrames, reducedChunkFrames);
-  }
-  if (reducedChunkFrames > chunkFrames) {
-    reducedChunkFrames = chunkFrames;
-  }
-  size_t reducedChunkBytes = reducedChunkFrames * bytes_per_frame;
-  size_t lowWaterBytes =
-      std::max(chunkBytes, rb.capacity() / std::max<size_t>(1, lowWaterDivisor));
-  if (lowWaterBytes > rb.capacity()) {
-    lowWaterBytes = rb.capacity();
-  }
-  size_t highWaterBytes =
-      std::max(lowWaterBytes + reducedChunkBytes,
-               rb.capacity() / std::max<size_t>(1, highWaterDivisor));
-  size_t minHysteresisBytes = std::max(chunkBytes, reducedChunkBytes * 3);
-  if (highWaterBytes < lowWaterBytes + minHysteresisBytes) {
-    highWaterBytes = lowWaterBytes + minHysteresisBytes;
-  }
-  if (highWaterBytes > rb.capacity()) {
-    highWaterBytes = rb.capacity();
-  }
-  if (highWaterBytes <= lowWaterBytes) {
-    if (lowWaterBytes > reducedChunkBytes) {
-      lowWaterBytes -= reducedChunkBytes;
-    } else {
-      lowWaterBytes = rb.capacity() / 2;
-    }
-    highWaterBytes = rb.capacity();
+  if (isRunning) {
+    // Time-to-first-sample breakdown, all from bridge start. "First sample"
+    // includes however long the host took to start playing.
+    int64_t origin = monotonicNanos(bridgeStart);
+    auto sinceStart = [origin](int64_t nanos) {
+      return nanos > 0 ? (long long)((nanos - origin) / 1000000) : -1LL;
+    };
+    LOGD("[Native] Startup: PCM open %lld ms (%d attempts), first sample %lld ms, "
+         "streaming %lld ms",
+         sinceStart(capture.openedNanos()), capture.openAttempts(),
+         sinceStart(capture.firstSampleNanos()),
+         sinceStart(monotonicNanos(std::chrono::steady_clock::now())));
   }
-  bool useReducedChunk = false;
-  LOGD("[Native] %s chunk strategy: normal=%d, reduced=%d, watermarks=%zu/%zu bytes, "
-       "emptySleep=%dus",
-       backendName, chunkFrames, reducedChunkFrames, lowWaterBytes, highWaterBytes, emptySleepUs);
-  std::vector<uint8_t> p_buf(chunkBytes);
+  reportStateToJava(3); // 3 = STREAMING
+  publishConfigStats(rate, actual_period_size, (int)deep_buffer_frames,
+                     (int)rb.capacity());
+
+  const ChunkStrategy chunking = ChunkStrategy::forEngine(
+      engineType, engine->getBurstFrames(), actual_period_size, rb.capacity());
+  const char *backendName = chunking.backendName;
+  if (chunking.burstFrames != chunking.rawBurstFrames) {
+    LOGD("[Native] %s burst clamped: raw=%d, using=%d", backendName,
+         chunking.rawBurstFrames, chunking.burstFrames);
+  }
+  const size_t normalFrames = chunking.normalFrames;
+  LOGD("[Native] %s chunk strategy: normal=%zu, reduced=%zu, watermarks=%zu/%zu frames",
+       backendName, chunking.normalFrames, chunking.reducedFrames,
+       chunking.lowWaterFrames, chunking.highWaterFrames);
+
+  // Rate adaptation replaces the chunk toggling: the stream runs a few
+  // hundred ppm fast or slow so the ring settles at the pre-roll level
+  // instead of drifting into the watermarks. Steering the host through the
+  // UAC2 feedback pitch fixes the drift at the source for free; resampling
+  // locally is the fallback when the gadget has no pitch control.
+  bool rateAdaptation = isRateAdaptationEnabled;
+  HostPitchControl hostPitch;
+  bool hostClockSync = rateAdaptation && hostPitch.open(card);
+  bool softwareResampling = rateAdaptation && !hostClockSync;
+  RateController rateController(target_preroll_frames, rate);
+  AdaptiveResampler<BridgeFrame> resampler;
+  std::vector<BridgeFrame> resampled(softwareResampling ? normalFrames : 0);
+  auto lastPitchUpdate = std::chrono::steady_clock::now();
+  if (rateAdaptation) {
+    LOGD("[Native] Clock sync: %s (target fill %zu frames, +-1000 ppm)",
+         hostClockSync ? "host feedback pitch" : "software resampling",
+         target_preroll_frames);
+  }
+  pullSource.enableResampling(softwareResampling);
+
+  // Adaptive latency: fold in the capture jitter seen since the last call
+  // and let the tuner move the target fill.
+  auto retuneLatency = [&](std::chrono::steady_clock::time_point now) {
+    tuner.onGap(capture.takeLateFrames());
+    if (!tuner.update(now))
+      return;
+    target_preroll_frames = tuner.targetFrames();
+    LOGD("[Native] Latency target -> %zu frames (%.1f ms, grows=%d, shrinks=%d)",
+         target_preroll_frames, target_preroll_frames * 1000.0 / rate, tuner.grows(),
+         tuner.shrinks());
+    reportLatencyTargetToJava((int)target_preroll_frames);
+    if (rateAdaptation)
+      rateController.setTarget(target_preroll_frames);
+  };
 
   // Consume Loop
-  int stats_counter = 0;
   bool isStreaming = true; // Initially true after pre-roll
   auto lastDataTime = std::chrono::steady_clock::now();
-  auto lastModeChangeTime = lastDataTime;
+  ChunkSelector chunkSelector(chunking, lastDataTime);
   auto lastModeLogTime = lastDataTime - std::chrono::seconds(10);
-  auto minModeDwell =
-      std::chrono::milliseconds((engineType == 0) ? 120 : 80);
-  int modeSwitchCount = 0;
 
-  while (isRunning) {
+  // Output side of the drift estimate. Engines with presentation timestamps
+  // report the real output clock; for the others, frames handed to a
+  // blocking write() track it closely enough over the estimator's window.
+  int64_t outputFrames = 0;
+  bool engineTimestamps = false;
+  auto lastDriftSample = std::chrono::steady_clock::now();
+
+  // Supervisor for callback engines: the data path is entirely inside the
+  // engine callback, so this only steers the clock and reports state.
+  uint64_t lastDataFrames = pullSource.dataFrames();
+  uint64_t lastRenderedFrames = pullSource.renderedFrames();
+  uint64_t lastUnderruns = pullSource.underrunCount();
+  auto lastStatsPublish = lastDataTime;
+  auto lastLatencySample = lastDataTime;
+  auto lastLatencyPublish = lastDataTime;
+  // Push mode: ring ran dry while streaming, counted once per dry spell.
+  uint64_t ringUnderruns = 0;
+  bool ringDry = false;
+  // Adaptive latency, push mode. After an audible underrun the ring is
+  // refilled to the target before writing resumes, instead of trickling
+  // single periods into an empty engine. Consumer stalls are timed from the
+  // start of one write to the top of the next iteration, before any wait
+  // for capture.
+  bool reprime = false;
+  auto reprimeStart = lastDataTime;
+  auto lastWriteStart = lastDataTime;
+  size_t lastWriteFrames = 0;
+  // Output engine stopped because the host closed its stream.
+  bool enginePaused = false;
+  while (pullMode && isRunning) {
+    if (bridgeStop.waitFor(std::chrono::milliseconds(10)))
+      break;
     auto now = std::chrono::steady_clock::now();
-    size_t availableBeforeRead = rb.available();
-    bool canSwitchMode = (now - lastModeChangeTime) >= minModeDwell;
-    if (canSwitchMode && !useReducedChunk && availableBeforeRead < lowWaterBytes) {
-      useReducedChunk = true;
-      lastModeChangeTime = now;
-      modeSwitchCount++;
+    pullSource.setMuted(isSpeakerMuted);
+    if (enginePaused) {
+      // The callback is what notices data, so restart once the host has
+      // re-primed the ring.
+      if (rb.available() < target_preroll_frames)
+        continue;
+      engine->start();
+      enginePaused = false;
+      lastDataTime = now;
+      LOGD("[Native] Host data back, output engine resumed.");
+    }
+
+    uint64_t dataFrames = pullSource.dataFrames();
+    uint64_t renderedFrames = pullSource.renderedFrames();
+    size_t renderedDelta = (size_t)(renderedFrames - lastRenderedFrames);
+    bool gotData = dataFrames != lastDataFrames;
+    lastDataFrames = dataFrames;
+    lastRenderedFrames = renderedFrames;
+
+    if (gotData) {
+      lastDataTime = now;
+      if (!isStreaming) {
+        isStreaming = true;
+        reportStateToJava(3); // 3 = STREAMING
+        rateController.reset();
+        drift.resetOutput();
+      }
+    } else if (isStreaming && (now - lastDataTime) > std::chrono::seconds(1)) {
+      isStreaming = false;
+      reportStateToJava(4); // 4 = IDLING
+      LOGD("[Native] Stream idle for 1s. State -> Waiting.");
+    }
+    if (!gotData && hostMonitor.hostStream() == HostStream::Closed &&
+        rb.available() == 0) {
+      // Host closed and everything it sent has played: stop the output
+      // stream until it comes back.
+      if (isStreaming) {
+        isStreaming = false;
+        reportStateToJava(4); // 4 = IDLING
+      }
+      engine->stop();
+      enginePaused = true;
+      LOGD("[Native] Host closed the stream, output engine paused.");
+    }
+    size_t fill = rb.available();
+    outputStats.observe(fill);
+    if ((now - lastStatsPublish) >= kStatsPublishInterval) {
+      outputStats.publish(fill, pullSource.underrunCount(), 0, drift.ppm());
+      if (adaptiveLatency && isStreaming)
+        retuneLatency(now);
+      lastStatsPublish = now;
+    }
+    if (!isStreaming)
+      continue;
+
+    if ((now - lastLatencySample) >= kLatencySampleInterval) {
+      latency.sample(fill, engine->getQueuedFrames());
+      lastLatencySample = now;
+    }
+    if ((now - lastLatencyPublish) >= kLatencyWindow) {
+      publishLatencyStats(latency);
+      lastLatencyPublish = now;
+    }
+
+    uint64_t underruns = pullSource.underrunCount();
+    if (underruns != lastUnderruns) {
       if ((now - lastModeLogTime) >= std::chrono::milliseconds(2000)) {
-        LOGD("[Native] Low ring fill (%zu bytes), switching to reduced chunk. "
-             "(switches=%d)",
-             availableBeforeRead, modeSwitchCount);
+        LOGE("[Native] AAudio callback underrun (events=%llu, frames=%llu)",
+             (unsigned long long)underruns,
+             (unsigned long long)pullSource.underrunFrames());
         lastModeLogTime = now;
       }
-    } else if (canSwitchMode && useReducedChunk &&
-               availableBeforeRead > highWaterBytes) {
-      useReducedChunk = false;
-      lastModeChangeTime = now;
-      modeSwitchCount++;
-      if ((now - lastModeLogTime) >= std::chrono::milliseconds(2000)) {
-        LOGD("[Native] Ring fill recovered (%zu bytes), restoring normal chunk. "
+      if (adaptiveLatency)
+        tuner.onUnderrun(now);
+      lastUnderruns = underruns;
+    }
+
+    if (rateAdaptation && renderedDelta > 0) {
+      rateController.update(fill, renderedDelta);
+      if (softwareResampling) {
+        pullSource.setRatio(rateController.ratio());
+      } else if ((now - lastPitchUpdate) >= std::chrono::milliseconds(100)) {
+        hostPitch.setPpm(-static_cast<int>(std::lround(rateController.ppm())));
+        lastPitchUpdate = now;
+      }
+    }
+
+    if (now - lastDriftSample >= kDriftSampleInterval) {
+      int64_t position = 0;
+      int64_t timeNs = 0;
+      if (engine->getTimestamp(&position, &timeNs)) {
+        drift.addOutputSample(position, timeNs);
+      }
+      lastDriftSample = now;
+    }
+  }
+
+  while (!pullMode && isRunning) {
+    if (adaptiveLatency && lastWriteFrames > 0) {
+      int64_t sinceWrite = std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - lastWriteStart)
+                               .count() * rate / 1000000;
+      if (sinceWrite > (int64_t)lastWriteFrames)
+        tuner.onGap((size_t)(sinceWrite - (int64_t)lastWriteFrames));
+      lastWriteFrames = 0;
+    }
+    if (singleThread) {
+      // Only block while the ring cannot supply a full chunk (or, while
+      // re-priming, the target fill).
+      size_t wantFrames = reprime ? target_preroll_frames : normalFrames;
+      int timeoutMs = rb.available() >= wantFrames ? 0 : (int)kRingWaitTimeout.count();
+      if (!pumpCapture(timeoutMs))
+        break;
+    }
+    auto now = std::chrono::steady_clock::now();
+    size_t availableBeforeRead = rb.available();
+    outputStats.observe(availableBeforeRead);
+
+    if (adaptiveLatency && ringDry && isStreaming && !reprime && availableBeforeRead > 0 &&
+        engine->getQueuedFrames() < chunking.burstFrames) {
+      // Data is back after a dry spell that also drained the engine: the
+      // output glitched.
+      tuner.onUnderrun(now);
+      reprime = true;
+      reprimeStart = now;
+    }
+    if (reprime) {
+      if (availableBeforeRead < target_preroll_frames && isStreaming &&
+          (now - reprimeStart) < kReprimeTimeout) {
+        if (!singleThread)
+          rb.waitForReadable(target_preroll_frames, kRingWaitTimeout);
+        continue;
+      }
+      reprime = false;
+    }
+    ChunkSelector::Switch modeSwitch = rateAdaptation
+                                           ? ChunkSelector::Switch::None
+                                           : chunkSelector.update(availableBeforeRead, now);
+    if (modeSwitch != ChunkSelector::Switch::None &&
+        (now - lastModeLogTime) >= std::chrono::milliseconds(2000)) {
+      if (modeSwitch == ChunkSelector::Switch::ToReduced) {
+        LOGD("[Native] Low ring fill (%zu frames), switching to reduced chunk. "
              "(switches=%d)",
-             availableBeforeRead, modeSwitchCount);
-        lastModeLogTime = now;
+             availableBeforeRead, chunkSelector.switchCount());
+      } else {
+        LOGD("[Native] Ring fill recovered (%zu frames), restoring normal chunk. "
+             "(switches=%d)",
+             availableBeforeRead, chunkSelector.switchCount());
       }
+      lastModeLogTime = now;
     }
 
-    size_t desiredChunkBytes = useReducedChunk ? reducedChunkBytes : chunkBytes;
-    size_t read_bytes = rb.read(p_buf.data(), desiredChunkBytes);
+    size_t desiredFrames = chunkSelector.chunkFrames();
+    if (softwareResampling) {
+      // Reserve a little more than one chunk so a fast ratio never starves
+      // the resampler mid-chunk; unused frames stay in the ring.
+      desiredFrames = normalFrames + normalFrames / 64 + 4;
+    }
+    // Drain in place: the engine reads straight from ring storage and the
+    // space is only handed back to capture once the write has returned.
+    BridgeRingBuffer::Regions span = rb.beginRead(desiredFrames);
+    size_t read_frames = span.frames();
 
-    if (read_bytes > 0) {
+    if (read_frames > 0) {
       lastDataTime = now;
+      ringDry = false;
+      if (enginePaused) {
+        engine->start();
+        enginePaused = false;
+        LOGD("[Native] Host data back, output engine resumed.");
+      }
       if (!isStreaming) {
         isStreaming = true;
         // Resume detected
         reportStateToJava(3); // 3 = STREAMING
-        reportStatsToJava(rate, actual_period_size, (int)deep_buffer_frames);
-        stats_counter = 0;
+        rateController.reset();
+        resampler.reset();
+        drift.resetOutput();
       }
 
-      if (isSpeakerMuted) {
-        std::memset(p_buf.data(), 0, read_bytes);
+      if (rateAdaptation) {
+        rateController.update(availableBeforeRead,
+                              softwareResampling ? normalFrames : read_frames);
+      }
+      // A mixer write per chunk is wasted effort: the host only samples
+      // the feedback value every few milliseconds and the loop is slow.
+      if (hostClockSync && (now - lastPitchUpdate) >= std::chrono::milliseconds(100)) {
+        // A filling ring means the host runs fast: ask it to slow down.
+        hostPitch.setPpm(-static_cast<int>(std::lround(rateController.ppm())));
+        lastPitchUpdate = now;
       }
 
-      engine->write(p_buf.data(), read_bytes);
+      if (softwareResampling) {
+        resampler.setRatio(rateController.ratio());
+
+        size_t consumed = 0;
+        size_t produced = resampler.process(span.first.data, span.first.frames,
+                                            resampled.data(), normalFrames, &consumed);
+        if (consumed == span.first.frames && span.second.frames > 0) {
+          size_t consumedSecond = 0;
+          produced += resampler.process(span.second.data, span.second.frames,
+                                        resampled.data() + produced,
+                                        normalFrames - produced, &consumedSecond);
+          consumed += consumedSecond;
+        }
+        rb.commitRead(consumed);
+        lastWriteFrames = produced;
+
+        if (produced > 0) {
+          if (isSpeakerMuted) {
+            std::memset(resampled.data(), 0, produced * sizeof(BridgeFrame));
+          }
+          engine->write(reinterpret_cast<const uint8_t *>(resampled.data()),
+                        produced * sizeof(BridgeFrame));
+        }
+        outputFrames += produced;
+      } else {
+        if (isSpeakerMuted) {
+          std::memset(span.first.data, 0, span.first.bytes());
+          if (span.second.frames > 0) {
+            std::memset(span.second.data, 0, span.second.bytes());
+          }
+        }
+
+        engine->write(reinterpret_cast<const uint8_t *>(span.first.data),
+                      span.first.bytes());
+        if (span.second.frames > 0) {
+          engine->write(reinterpret_cast<const uint8_t *>(span.second.data),
+                        span.second.bytes());
+        }
+        rb.commitRead(read_frames);
+        lastWriteFrames = read_frames;
+        outputFrames += read_frames;
+      }
+      lastWriteStart = now;
+
+      if (now - lastDriftSample >= kDriftSampleInterval) {
+        int64_t position = 0;
+        int64_t timeNs = 0;
+        if (engine->getTimestamp(&position, &timeNs)) {
+          if (!engineTimestamps) {
+            // Switching clock source: drop the write-count history.
+            engineTimestamps = true;
+            drift.resetOutput();
+          }
+          drift.addOutputSample(position, timeNs);
+        } else if (!engineTimestamps) {
+          drift.addOutputSample(outputFrames,
+                                monotonicNanos(std::chrono::steady_clock::now()));
+        }
+        lastDriftSample = now;
+      }
     } else {
       // Buffer empty. Check for timeout (Idle detection)
+      if (isStreaming && !ringDry) {
+        ringDry = true;
+        ringUnderruns++;
+      }
       auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
                          now - lastDataTime)
                          .count();
-      if (isStreaming && elapsed > 1000) {
+      // A closed host stream is final as soon as the ring has drained; the
+      // 1 s timeout only covers gadgets without host events.
+      bool hostClosed = hostMonitor.hostStream() == HostStream::Closed;
+      if (isStreaming && (elapsed > 1000 || hostClosed)) {
         isStreaming = false;
         reportStateToJava(4); // 4 = IDLING
-        LOGD("[Native] Stream idle for 1s. State -> Waiting.");
+        LOGD("[Native] Stream idle%s. State -> Waiting.",
+             hostClosed ? " (host closed)" : " for 1s");
+      }
+      if (hostClosed && !enginePaused) {
+        // Nothing to play until the host reopens: stop the output stream
+        // (and its wakeups) meanwhile.
+        engine->stop();
+        enginePaused = true;
+        LOGD("[Native] Output engine paused.");
       }
-      std::this_thread::sleep_for(std::chrono::microseconds(emptySleepUs));
+      // Sleep until capture commits the next frame; the timeout only bounds
+      // how long a stop request can go unnoticed. In single-thread mode the
+      // poll at the top of the loop is the wait.
+      if (!singleThread)
+        rb.waitForReadable(1, kRingWaitTimeout);
     }
 
-    // Periodic stats update (only when streaming)
-    if (isStreaming && ++stats_counter > 500) {
-      reportStatsToJava(rate, actual_period_size, (int)deep_buffer_frames);
-      stats_counter = 0;
+    if (isStreaming && (now - lastLatencySample) >= kLatencySampleInterval) {
+      latency.sample(availableBeforeRead, engine->getQueuedFrames());
+      lastLatencySample = now;
+    }
+    if ((now - lastLatencyPublish) >= kLatencyWindow) {
+      publishLatencyStats(latency);
+      lastLatencyPublish = now;
+    }
+    if ((now - lastStatsPublish) >= kStatsPublishInterval) {
+      outputStats.publish(availableBeforeRead, ringUnderruns, chunkSelector.switchCount(), drift.ppm());
+      if (adaptiveLatency && isStreaming)
+        retuneLatency(now);
+      lastStatsPublish = now;
     }
   }
 
+  stopWaker.reset();
   engine->stop();
   engine->close();
   delete engine;
 
   if (c_thread.joinable())
     c_thread.join();
+  capture.close();
+  hostMonitor.stop();
+  if (timerFd >= 0)
+    close(timerFd);
   if (micThread.joinable())
     micThread.join();
 
   LOGD("[Native] Bridge task finished.");
   reportStateToJava(0); // 0 = STOPPED
-  isFinished = true;    // Signal we are mostly done (safe to restart)
-
-  // Detach thread if attached (safe to call even if not attached? No, better
-  // check) But we reused helper functions that attach/detach locally. Only
-  // JavaAudioTrackEngine calls GetEnv/Attach. Standard JNI practice: Detach if
-  // you Attached.
-  if (javaVM) {
-    javaVM->DetachCurrentThread();
-  }
+  markBridgeFinished(); // Signal we are mostly done (safe to restart)
+  // The JNI attachment made by attachedEnv() is released at thread exit.
 }
@@ -1,9 +1,8 @@
 #ifndef BRIDGE_H
 #define BRIDGE_H
 
-#include <jni.h>
-
 #include <atomic>
+#include <chrono>
 #include <thread>
 
 // Global Execution State
@@ -11,8 +10,29 @@ extern std::atomic<bool> isRunning;
 extern std::atomic<bool> isFinished;  // Synchronization flag
 extern std::atomic<bool> isSpeakerMuted;
 extern std::atomic<bool> isMicMuted;
+extern std::atomic<bool> isRateAdaptationEnabled;  // Read once per bridge start
+extern std::atomic<bool> isCpuPinningEnabled;      // Read as each audio thread starts
+extern std::atomic<bool> isSingleThreadEnabled;    // Read once per bridge start
+// Last capture period layout that worked for this request, 0 if none. Read
+// once per bridge start and tried before anything else.
+extern std::atomic<int> captureHintPeriodFrames;
+extern std::atomic<int> captureHintPeriodCount;
+extern std::atomic<bool> isAdaptiveLatencyEnabled;  // Read once per bridge start
+// Target fill adaptive latency last settled on for this route, 0 if none.
+// Read once per bridge start.
+extern std::atomic<int> latencyTargetHintFrames;
 extern std::thread bridgeThread;
 
+// Blocks until the last bridgeTask has torn down (isFinished). False if it
+// is still running after `timeout`.
+bool waitForBridgeFinished(std::chrono::milliseconds timeout);
+
+class AudioBackend;
+
+// Engines used by the next bridgeTask. Without one, output goes to a paced
+// NullAudioEngine and the mic path is unavailable. Must outlive the bridge.
+void setAudioBackend(AudioBackend* backend);
+
 // Main Bridge Task
 void bridgeTask(int card, int device, int bufferSizeFrames, int periodSizeFrames, int engineType,
                 int sampleRate, int activeDirections, int micSource);
@@ -0,0 +1,11 @@
+#include "bridge_stats.h"
+
+#include <time.h>
+
+BridgeStatsBlock bridgeStats;
+
+int32_t threadCpuMillis() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<int32_t>(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
@@ -0,0 +1,96 @@
+#ifndef BRIDGE_STATS_H
+#define BRIDGE_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+// --- Shared Bridge Statistics ---
+// One block in native memory for the life of the process, handed to Kotlin
+// once as a direct ByteBuffer (see NativeStats.kt for the reader). The UI
+// polls it at its own rate; the audio threads never call into Java for
+// stats.
+//
+// Each section has exactly one writer thread and its own sequence counter
+// (seqlock): odd while an update is in progress. Every field is a 32-bit
+// lock-free atomic, so individual values never tear on any ABI and the
+// writer only does relaxed stores between two sequence bumps.
+//
+// The layout is part of the Kotlin contract: append fields and bump
+// kStatsLayoutVersion, never reorder.
+static constexpr int32_t kStatsLayoutVersion = 3;
+
+struct BridgeStatsBlock {
+    std::atomic<int32_t> layoutVersion{kStatsLayoutVersion};  // 0
+
+    // Config section (bridge thread, once per start).
+    std::atomic<uint32_t> configSequence{0};  // 4
+    std::atomic<int32_t> sampleRate{0};       // 8
+    std::atomic<int32_t> periodFrames{0};     // 12
+    std::atomic<int32_t> bufferFrames{0};     // 16
+    std::atomic<int32_t> ringCapacity{0};     // 20
+
+    // Output section (bridge thread / callback supervisor).
+    std::atomic<uint32_t> outputSequence{0};  // 24
+    std::atomic<int32_t> ringFill{0};         // 28
+    std::atomic<int32_t> ringFillMin{0};      // 32, over the last publish window
+    std::atomic<int32_t> ringFillMax{0};      // 36
+    std::atomic<int32_t> underruns{0};        // 40
+    std::atomic<int32_t> modeSwitches{0};     // 44
+    std::atomic<float> driftPpm{0.0f};        // 48, NaN while unknown
+    std::atomic<int32_t> outputCpuMs{0};      // 52
+
+    // Capture section (capture thread).
+    std::atomic<uint32_t> captureSequence{0};  // 56
+    std::atomic<int32_t> overruns{0};          // 60
+    std::atomic<int32_t> xruns{0};             // 64
+    std::atomic<int32_t> captureCpuMs{0};      // 68
+
+    // Latency section (bridge thread): host-to-speaker estimate, see
+    // LatencyAccountant. Min/avg/max cover the last window.
+    std::atomic<uint32_t> latencySequence{0};     // 72
+    std::atomic<float> latencyMs{0.0f};           // 76
+    std::atomic<float> latencyMinMs{0.0f};        // 80
+    std::atomic<float> latencyAvgMs{0.0f};        // 84
+    std::atomic<float> latencyMaxMs{0.0f};        // 88
+    std::atomic<int32_t> captureDelayFrames{0};   // 92
+    std::atomic<int32_t> engineQueuedFrames{-1};  // 96, -1 when unknown
+
+    // Scheduling, indexed by AudioThreadRole. Single values each written
+    // only by their own thread, so no sequence.
+    // threadSched is (policy << 8) | priority.
+    std::atomic<int32_t> threadSched[3] = {{-1}, {-1}, {-1}};  // 100
+    std::atomic<int32_t> threadCpu[3] = {{-1}, {-1}, {-1}};    // 112, last CPU seen
+};
+
+static_assert(sizeof(BridgeStatsBlock) == 124, "BridgeStatsBlock layout is shared with Kotlin");
+static_assert(std::atomic<int32_t>::is_always_lock_free, "stats fields must be lock-free");
+static_assert(std::atomic<float>::is_always_lock_free, "stats fields must be lock-free");
+
+extern BridgeStatsBlock bridgeStats;
+
+// Writer side of one section's seqlock. Only the section's owner thread may
+// hold one.
+class StatsUpdate {
+public:
+    explicit StatsUpdate(std::atomic<uint32_t>& sequence) : sequence_(sequence) {
+        uint32_t odd = sequence_.load(std::memory_order_relaxed) + 1;
+        sequence_.store(odd, std::memory_order_relaxed);
+        // Field stores below must not become visible before the odd value.
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    ~StatsUpdate() {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+    }
+
+    StatsUpdate(const StatsUpdate&) = delete;
+    StatsUpdate& operator=(const StatsUpdate&) = delete;
+
+private:
+    std::atomic<uint32_t>& sequence_;
+};
+
+// CPU time consumed by the calling thread, in milliseconds.
+int32_t threadCpuMillis();
+
+#endif  // BRIDGE_STATS_H
@@ -0,0 +1,29 @@
+#include "buffer_plan.h"
+
+#include <algorithm>
+
+BufferPlan BufferPlan::forRequest(int bufferSizeFrames, int rate) {
+    size_t deepFrames = (size_t)std::max(480, bufferSizeFrames);
+    return withGuard(bufferSizeFrames, rate, std::max<size_t>(240, deepFrames / 4));
+}
+
+BufferPlan BufferPlan::withGuard(int bufferSizeFrames, int rate, size_t guardFrames) {
+    BufferPlan plan;
+    plan.deepFrames = (size_t)std::max(480, bufferSizeFrames);
+    plan.guardFrames = guardFrames;
+    if (rate <= 0) rate = 48000;
+
+    // Use a slightly higher target on larger buffers for older-device stability.
+    size_t configuredMs = (plan.deepFrames * 1000) / rate;
+    size_t prerollMs = 50;
+    if (configuredMs >= 80) {
+        prerollMs = 65;
+    } else if (configuredMs >= 60) {
+        prerollMs = 55;
+    }
+    // Cap at 50% of ring capacity to avoid deadlock on tiny buffers, and
+    // wait for at least one frame.
+    plan.prerollFrames = std::min((size_t)rate * prerollMs / 1000, plan.ringFrames() / 2);
+    if (plan.prerollFrames == 0) plan.prerollFrames = 1;
+    return plan;
+}
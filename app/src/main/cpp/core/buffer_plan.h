@@ -0,0 +1,24 @@
+#ifndef BUFFER_PLAN_H
+#define BUFFER_PLAN_H
+
+#include <cstddef>
+
+// --- Speaker Ring Sizing ---
+// The ring holds the user's buffer setting plus an internal guard margin
+// that absorbs scheduler/USB jitter on older devices without changing the
+// visible setting. Playback starts once the ring holds the pre-roll.
+struct BufferPlan {
+    size_t deepFrames;     // Requested buffer, at least 480
+    size_t guardFrames;    // Jitter margin on top
+    size_t prerollFrames;  // Fill required before playback starts
+
+    size_t ringFrames() const { return deepFrames + guardFrames; }
+
+    // The fixed guard: max(240, deep / 4).
+    static BufferPlan forRequest(int bufferSizeFrames, int rate);
+    // Same request with an explicit guard; the pre-roll is re-capped to the
+    // resulting ring.
+    static BufferPlan withGuard(int bufferSizeFrames, int rate, size_t guardFrames);
+};
+
+#endif  // BUFFER_PLAN_H
@@ -0,0 +1,101 @@
+#include "chunk_strategy.h"
+
+#include <algorithm>
+
+ChunkStrategy ChunkStrategy::forEngine(int engineType, int32_t burstFrames, int32_t periodFrames,
+                                       size_t ringCapacity) {
+    ChunkStrategy s;
+    if (burstFrames <= 0) burstFrames = 192;  // Fallback
+    s.rawBurstFrames = burstFrames;
+
+    int32_t minTargetFrames;
+    int32_t maxTargetFrames;
+    size_t lowWaterDivisor;
+    size_t highWaterDivisor = 2;
+    // Some devices report very large "burst" values for AAudio/AudioTrack.
+    // Clamp to sane ranges so the watermarks stay meaningful.
+    int32_t maxBurstFrames;
+    if (engineType == 1) {
+        s.backendName = "OpenSL";
+        minTargetFrames = 96;
+        maxTargetFrames = 192;
+        lowWaterDivisor = 3;
+        maxBurstFrames = 256;
+    } else if (engineType == 2) {
+        s.backendName = "AudioTrack";
+        minTargetFrames = 120;
+        maxTargetFrames = 480;
+        lowWaterDivisor = 3;
+        maxBurstFrames = 960;
+    } else {
+        s.backendName = "AAudio";
+        minTargetFrames = 96;
+        maxTargetFrames = 240;
+        // Wider hysteresis for AAudio to avoid rapid normal/reduced oscillation.
+        lowWaterDivisor = 8;
+        maxBurstFrames = 384;
+    }
+    burstFrames = std::max<int32_t>(96, std::min<int32_t>(burstFrames, maxBurstFrames));
+    s.burstFrames = burstFrames;
+
+    // Use a chunk close to the capture period when available.
+    // Backend-specific bounds: AAudio prefers smaller writes for stability on
+    // some older devices, AudioTrack can tolerate bigger chunks.
+    int32_t targetFrames = (periodFrames > 0) ? periodFrames : burstFrames;
+    int32_t boundedTarget =
+        std::max<int32_t>(minTargetFrames, std::min<int32_t>(targetFrames, maxTargetFrames));
+    int32_t chunkFrames = std::max(burstFrames, boundedTarget);
+    int32_t reducedChunkFrames = std::max<int32_t>(96, chunkFrames / 2);
+    if (engineType == 1) {
+        // OpenSL queueing is less predictable with tiny buffers.
+        reducedChunkFrames = std::max<int32_t>(burstFrames, reducedChunkFrames);
+    }
+    if (reducedChunkFrames > chunkFrames) {
+        reducedChunkFrames = chunkFrames;
+    }
+    size_t normalFrames = chunkFrames;
+    size_t reducedFrames = reducedChunkFrames;
+    size_t lowWaterFrames = std::max(normalFrames, ringCapacity / lowWaterDivisor);
+    if (lowWaterFrames > ringCapacity) {
+        lowWaterFrames = ringCapacity;
+    }
+    size_t highWaterFrames =
+        std::max(lowWaterFrames + reducedFrames, ringCapacity / highWaterDivisor);
+    size_t minHysteresisFrames = std::max(normalFrames, reducedFrames * 3);
+    if (highWaterFrames < lowWaterFrames + minHysteresisFrames) {
+        highWaterFrames = lowWaterFrames + minHysteresisFrames;
+    }
+    if (highWaterFrames > ringCapacity) {
+        highWaterFrames = ringCapacity;
+    }
+    if (highWaterFrames <= lowWaterFrames) {
+        if (lowWaterFrames > reducedFrames) {
+            lowWaterFrames -= reducedFrames;
+        } else {
+            lowWaterFrames = ringCapacity / 2;
+        }
+        highWaterFrames = ringCapacity;
+    }
+
+    s.normalFrames = normalFrames;
+    s.reducedFrames = reducedFrames;
+    s.lowWaterFrames = lowWaterFrames;
+    s.highWaterFrames = highWaterFrames;
+    s.minModeDwell = std::chrono::milliseconds((engineType == 0) ? 120 : 80);
+    return s;
+}
+
+ChunkSelector::Switch ChunkSelector::update(size_t fill,
+                                            std::chrono::steady_clock::time_point now) {
+    if (now - lastSwitch_ < strategy_.minModeDwell) return Switch::None;
+    if (!reduced_ && fill < strategy_.lowWaterFrames) {
+        reduced_ = true;
+    } else if (reduced_ && fill > strategy_.highWaterFrames) {
+        reduced_ = false;
+    } else {
+        return Switch::None;
+    }
+    lastSwitch_ = now;
+    switches_++;
+    return reduced_ ? Switch::ToReduced : Switch::ToNormal;
+}
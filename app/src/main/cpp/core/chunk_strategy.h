@@ -0,0 +1,55 @@
+#ifndef CHUNK_STRATEGY_H
+#define CHUNK_STRATEGY_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// --- Output Chunk Strategy ---
+// How much the push loop takes from the ring per engine write. It uses a
+// normal chunk near the capture period and drops to a reduced chunk when
+// the ring runs low, switching back once it has refilled past the high
+// watermark. Rate adaptation replaces the toggling; the bridge then keeps
+// the normal chunk.
+struct ChunkStrategy {
+    const char* backendName;
+    int32_t rawBurstFrames;  // As the engine reported it
+    int32_t burstFrames;     // Clamped to the backend's sane range
+    size_t normalFrames;
+    size_t reducedFrames;
+    size_t lowWaterFrames;
+    size_t highWaterFrames;
+    std::chrono::milliseconds minModeDwell;
+
+    // engineType as passed to bridgeTask; periodFrames is the capture period,
+    // 0 when unknown.
+    static ChunkStrategy forEngine(int engineType, int32_t burstFrames, int32_t periodFrames,
+                                   size_t ringCapacity);
+};
+
+// Per-iteration normal/reduced decision with watermark hysteresis and a
+// minimum dwell between switches. Cheap enough to run on every write.
+class ChunkSelector {
+public:
+    enum class Switch { None, ToReduced, ToNormal };
+
+    ChunkSelector(const ChunkStrategy& strategy, std::chrono::steady_clock::time_point start)
+        : strategy_(strategy), lastSwitch_(start) {}
+
+    // `fill` is the ring fill before this iteration's read.
+    Switch update(size_t fill, std::chrono::steady_clock::time_point now);
+
+    size_t chunkFrames() const {
+        return reduced_ ? strategy_.reducedFrames : strategy_.normalFrames;
+    }
+    bool reduced() const { return reduced_; }
+    int switchCount() const { return switches_; }
+
+private:
+    ChunkStrategy strategy_;
+    std::chrono::steady_clock::time_point lastSwitch_;
+    bool reduced_ = false;
+    int switches_ = 0;
+};
+
+#endif  // CHUNK_STRATEGY_H
@@ -0,0 +1,147 @@
+#include "host_activity_monitor.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sound/asound.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <tinyalsa/mixer.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "../logging/logging.h"
+
+static const char* const kRateControlName = "Capture Rate";
+
+HostActivityMonitor::~HostActivityMonitor() {
+    stop();
+}
+
+bool HostActivityMonitor::start(unsigned int card, int expectedRate) {
+    stop();
+
+    mixer_ = mixer_open(card);
+    if (!mixer_) return false;
+    rateCtl_ = mixer_get_ctl_by_name(mixer_, kRateControlName);
+    if (!rateCtl_) {
+        mixer_close(mixer_);
+        mixer_ = nullptr;
+        return false;
+    }
+
+    // tinyalsa does not hand out the mixer's fd, and the wait has to include
+    // the quit signal; keep a second control handle just for events.
+    char path[32];
+    snprintf(path, sizeof(path), "/dev/snd/controlC%u", card);
+    ctlFd_ = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    int subscribe = 1;
+    if (ctlFd_ < 0 || ioctl(ctlFd_, SNDRV_CTL_IOCTL_SUBSCRIBE_EVENTS, &subscribe) < 0) {
+        LOGE("[Native] Host activity events unavailable: %s", strerror(errno));
+        stop();
+        return false;
+    }
+    changedFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    expectedRate_ = expectedRate;
+    reportedRate_ = 0;
+    quit_.clear();
+    refresh();
+    LOGD("[Native] Host activity monitor: stream %s, rate %d",
+         hostStream() == HostStream::Open ? "open" : "closed", hostRate());
+    thread_ = std::thread(&HostActivityMonitor::run, this);
+    return true;
+}
+
+void HostActivityMonitor::stop() {
+    if (thread_.joinable()) {
+        quit_.raise();
+        thread_.join();
+    }
+    if (ctlFd_ >= 0) {
+        close(ctlFd_);
+        ctlFd_ = -1;
+    }
+    if (changedFd_ >= 0) {
+        close(changedFd_);
+        changedFd_ = -1;
+    }
+    rateCtl_ = nullptr;
+    if (mixer_) {
+        mixer_close(mixer_);
+        mixer_ = nullptr;
+    }
+    stream_.store(HostStream::Unknown);
+    rate_.store(0);
+}
+
+bool HostActivityMonitor::waitForChange(std::chrono::milliseconds timeout) {
+    struct pollfd fds[2] = {
+        {bridgeStop.fd(), POLLIN, 0},
+        {changedFd_, POLLIN, 0},
+    };
+    if (poll(fds, 2, static_cast<int>(timeout.count())) <= 0) return false;
+    if (fds[1].revents & POLLIN) {
+        uint64_t count;
+        (void)read(changedFd_, &count, sizeof(count));
+    }
+    return (fds[0].revents & POLLIN) != 0;
+}
+
+void HostActivityMonitor::run() {
+    struct pollfd fds[2] = {
+        {ctlFd_, POLLIN, 0},
+        {quit_.fd(), POLLIN, 0},
+    };
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) break;
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            // Card went away (gadget unbound); the bridge notices on its own.
+            LOGE("[Native] Host activity monitor lost the control device");
+            break;
+        }
+
+        bool rateChanged = false;
+        struct snd_ctl_event event;
+        while (read(ctlFd_, &event, sizeof(event)) == sizeof(event)) {
+            if (event.type == SNDRV_CTL_EVENT_ELEM &&
+                (event.data.elem.mask & SNDRV_CTL_EVENT_MASK_VALUE) &&
+                strcmp(reinterpret_cast<const char*>(event.data.elem.id.name),
+                       kRateControlName) == 0) {
+                rateChanged = true;
+            }
+        }
+        if (rateChanged) refresh();
+    }
+}
+
+void HostActivityMonitor::refresh() {
+    int rate = mixer_ctl_get_value(rateCtl_, 0);
+    if (rate < 0) rate = 0;
+    HostStream stream = rate > 0 ? HostStream::Open : HostStream::Closed;
+    HostStream previous = stream_.exchange(stream);
+    int previousRate = rate_.exchange(rate);
+    if (previous == stream && previousRate == rate) return;
+
+    if (previous != HostStream::Unknown) {
+        LOGD("[Native] Host %s the stream (rate %d)",
+             stream == HostStream::Open ? "opened" : "closed", rate);
+    }
+    if (changedFd_ >= 0) {
+        uint64_t one = 1;
+        (void)write(changedFd_, &one, sizeof(one));
+    }
+    if (rate > 0 && rate != expectedRate_ && rate != reportedRate_) {
+        // The capture PCM runs at the start rate; only a restart can follow.
+        LOGE("[Native] Host switched to %d Hz (bridge runs at %d Hz)", rate, expectedRate_);
+        reportedRate_ = rate;
+        reportHostRateToJava(rate);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef HOST_ACTIVITY_MONITOR_H
+#define HOST_ACTIVITY_MONITOR_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "stop_signal.h"
+
+struct mixer;
+struct mixer_ctl;
+
+enum class HostStream { Unknown, Closed, Open };
+
+// --- Host Activity Monitor ---
+// u_audio based gadgets (f_uac1/f_uac2, 5.18+) expose "Capture Rate": the
+// rate the host streams at while its playback interface is active, 0 while
+// it is closed, with a control event on every change. A small thread sleeps
+// on the control device and turns those events into state, so the bridge
+// learns about host open/close and rate switches within milliseconds
+// instead of inferring them from data timeouts.
+class HostActivityMonitor {
+public:
+    HostActivityMonitor() = default;
+    ~HostActivityMonitor();
+
+    HostActivityMonitor(const HostActivityMonitor&) = delete;
+    HostActivityMonitor& operator=(const HostActivityMonitor&) = delete;
+
+    // Returns false when the card has no rate control (older kernels); the
+    // state then stays Unknown and callers keep their timeout heuristics.
+    // A host rate other than `expectedRate` is reported to Java.
+    bool start(unsigned int card, int expectedRate);
+
+    void stop();
+
+    HostStream hostStream() const { return stream_.load(std::memory_order_relaxed); }
+
+    // Current host rate, 0 while closed or unknown.
+    int hostRate() const { return rate_.load(std::memory_order_relaxed); }
+
+    // Sleep up to `timeout`, returning early when the host state changes or
+    // the bridge is stopped. Returns true if the bridge was stopped.
+    bool waitForChange(std::chrono::milliseconds timeout);
+
+private:
+    void run();
+    void refresh();
+
+    struct mixer* mixer_ = nullptr;
+    struct mixer_ctl* rateCtl_ = nullptr;
+    int ctlFd_ = -1;      // Control device with event subscription
+    int changedFd_ = -1;  // eventfd bumped on every state change
+    int expectedRate_ = 0;
+    int reportedRate_ = 0;
+
+    StopSignal quit_;
+    std::thread thread_;
+    std::atomic<HostStream> stream_{HostStream::Unknown};
+    std::atomic<int> rate_{0};
+};
+
+#endif  // HOST_ACTIVITY_MONITOR_H
@@ -0,0 +1,68 @@
+#include "host_pitch_control.h"
+
+#include <tinyalsa/mixer.h>
+
+#include <algorithm>
+
+#include "../logging/logging.h"
+
+static const char* const kPitchControlName = "Capture Pitch 1000000";
+
+HostPitchControl::~HostPitchControl() {
+    close();
+}
+
+bool HostPitchControl::open(unsigned int card) {
+    close();
+
+    mixer_ = mixer_open(card);
+    if (!mixer_) return false;
+
+    ctl_ = mixer_get_ctl_by_name(mixer_, kPitchControlName);
+    if (!ctl_) {
+        mixer_close(mixer_);
+        mixer_ = nullptr;
+        return false;
+    }
+
+    min_ = mixer_ctl_get_range_min(ctl_);
+    max_ = mixer_ctl_get_range_max(ctl_);
+    if (min_ > kNominal || max_ < kNominal) {
+        // Not the control we expect; leave it alone.
+        LOGE("[Native] Pitch control range %d..%d does not include nominal", min_, max_);
+        ctl_ = nullptr;
+        mixer_close(mixer_);
+        mixer_ = nullptr;
+        return false;
+    }
+
+    current_ = mixer_ctl_get_value(ctl_, 0);
+    LOGD("[Native] Host pitch control found (range %d..%d ppm, current %d)", min_ - kNominal,
+         max_ - kNominal, current_ - kNominal);
+    return true;
+}
+
+void HostPitchControl::close() {
+    if (ctl_ && current_ != kNominal) {
+        mixer_ctl_set_value(ctl_, 0, kNominal);
+    }
+    ctl_ = nullptr;
+    current_ = kNominal;
+    if (mixer_) {
+        mixer_close(mixer_);
+        mixer_ = nullptr;
+    }
+}
+
+int HostPitchControl::setPpm(int ppm) {
+    if (!ctl_) return 0;
+
+    int value = std::max(min_, std::min(max_, kNominal + ppm));
+    if (value != current_) {
+        if (mixer_ctl_set_value(ctl_, 0, value) != 0) {
+            return current_ - kNominal;
+        }
+        current_ = value;
+    }
+    return current_ - kNominal;
+}
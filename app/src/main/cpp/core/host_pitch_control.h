@@ -0,0 +1,44 @@
+#ifndef HOST_PITCH_CONTROL_H
+#define HOST_PITCH_CONTROL_H
+
+struct mixer;
+struct mixer_ctl;
+
+// --- UAC2 Host Feedback Pitch ---
+// Recent f_uac2 kernels expose "Capture Pitch 1000000" on the gadget card.
+// The value scales the rate reported through the feedback endpoint (1000000
+// = nominal), so the host itself speeds up or slows down its stream and no
+// resampling is needed on the phone.
+class HostPitchControl {
+public:
+    HostPitchControl() = default;
+    ~HostPitchControl();
+
+    HostPitchControl(const HostPitchControl&) = delete;
+    HostPitchControl& operator=(const HostPitchControl&) = delete;
+
+    // Returns false when the card has no pitch control (older kernels, UAC1).
+    bool open(unsigned int card);
+
+    // Restores nominal pitch and releases the mixer.
+    void close();
+
+    bool isOpen() const { return ctl_ != nullptr; }
+
+    // Ask the host to deliver `ppm` faster (positive) or slower (negative)
+    // than nominal. Clamped to the control's range; returns the applied ppm.
+    int setPpm(int ppm);
+
+    int ppm() const { return current_ - kNominal; }
+
+private:
+    static constexpr int kNominal = 1000000;
+
+    struct mixer* mixer_ = nullptr;
+    struct mixer_ctl* ctl_ = nullptr;
+    int min_ = kNominal;
+    int max_ = kNominal;
+    int current_ = kNominal;
+};
+
+#endif  // HOST_PITCH_CONTROL_H
@@ -0,0 +1,33 @@
+#include "latency_accountant.h"
+
+#include <algorithm>
+
+void LatencyAccountant::sample(size_t ringFrames, int64_t engineFrames) {
+    engine_frames_ = engineFrames;
+    int64_t total = captureDelay() + static_cast<int64_t>(ringFrames) +
+                    std::max<int64_t>(0, engineFrames);
+
+    current_ = total;
+    if (count_ == 0) {
+        min_ = total;
+        max_ = total;
+    } else {
+        min_ = std::min(min_, total);
+        max_ = std::max(max_, total);
+    }
+    sum_ += total;
+    count_++;
+}
+
+bool LatencyAccountant::takeWindow(Window* out) {
+    if (count_ == 0) return false;
+
+    out->currentMs = toMs(current_);
+    out->minMs = toMs(min_);
+    out->maxMs = toMs(max_);
+    out->avgMs = toMs(sum_) / static_cast<float>(count_);
+
+    sum_ = 0;
+    count_ = 0;
+    return true;
+}
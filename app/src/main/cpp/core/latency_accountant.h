@@ -0,0 +1,61 @@
+#ifndef LATENCY_ACCOUNTANT_H
+#define LATENCY_ACCOUNTANT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// --- Latency Accountant ---
+// Host-to-speaker latency as the sum of every place a frame waits on the
+// phone: the gadget capture buffer (ALSA delay), the bridge ring, and the
+// output engine's own queue. Each sample is the instantaneous sum; the
+// accountant keeps min/avg/max over a window that the owner closes at its
+// own publish rate. Output mixer and DAC latency past the engine queue are
+// not visible to any of the engines and are not included.
+class LatencyAccountant {
+public:
+    struct Window {
+        float currentMs = 0.0f;
+        float minMs = 0.0f;
+        float avgMs = 0.0f;
+        float maxMs = 0.0f;
+    };
+
+    explicit LatencyAccountant(int sampleRate)
+        : sampleRate_(sampleRate > 0 ? sampleRate : 48000) {}
+
+    // Capture thread: frames the host has delivered that are not yet read
+    // from the PCM. Negative (query failed) keeps the previous value.
+    void setCaptureDelay(long frames) {
+        if (frames >= 0) {
+            captureDelay_.store(static_cast<int32_t>(frames), std::memory_order_relaxed);
+        }
+    }
+    int32_t captureDelay() const { return captureDelay_.load(std::memory_order_relaxed); }
+
+    // Bridge thread only, from here on.
+    // `engineFrames` < 0 means the engine cannot report its queue.
+    void sample(size_t ringFrames, int64_t engineFrames);
+
+    // Summary of the samples since the previous call; false if there were
+    // none. Starts a new window.
+    bool takeWindow(Window* out);
+
+    // Engine queue from the most recent sample, or -1 when unknown.
+    int64_t engineFrames() const { return engine_frames_; }
+
+private:
+    float toMs(int64_t frames) const { return frames * 1000.0f / sampleRate_; }
+
+    int sampleRate_;
+    std::atomic<int32_t> captureDelay_{0};
+
+    int64_t engine_frames_ = -1;
+    int64_t current_ = 0;
+    int64_t min_ = 0;
+    int64_t max_ = 0;
+    int64_t sum_ = 0;
+    int64_t count_ = 0;
+};
+
+#endif  // LATENCY_ACCOUNTANT_H
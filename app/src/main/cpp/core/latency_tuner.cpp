@@ -0,0 +1,104 @@
+#include "latency_tuner.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// One dropout is often reported by more than one loop iteration.
+constexpr auto kUnderrunHoldoff = std::chrono::milliseconds(500);
+// How long the bridge has to run clean before each shrink step. A shrink
+// that has to be undone within that time doubles it, up to the maximum.
+constexpr auto kShrinkQuiet = std::chrono::seconds(20);
+constexpr auto kMaxShrinkQuiet = std::chrono::seconds(320);
+// Half-life of the gap history. Long enough that a periodic stall every
+// few seconds keeps the target up between occurrences.
+constexpr double kGapHalfLifeSec = 10.0;
+}  // namespace
+
+LatencyTuner::Bounds LatencyTuner::boundsFor(const BufferPlan& plan, int sampleRate) {
+    if (sampleRate <= 0) sampleRate = 48000;
+    Bounds bounds;
+    bounds.maxFrames = std::max<size_t>(1, plan.ringFrames() / 2);
+    bounds.minFrames = std::min<size_t>((size_t)sampleRate / 100, bounds.maxFrames);
+    bounds.stepFrames = std::max<size_t>(1, (size_t)sampleRate / 400);
+    return bounds;
+}
+
+LatencyTuner::LatencyTuner(const Bounds& bounds, size_t initialFrames, int sampleRate,
+                           Clock::time_point now)
+    : bounds_(bounds),
+      sampleRate_(sampleRate > 0 ? sampleRate : 48000),
+      lastUpdate_(now),
+      quietSince_(now),
+      shrinkQuiet_(kShrinkQuiet) {
+    target_ = (initialFrames >= bounds_.minFrames && initialFrames <= bounds_.maxFrames)
+                  ? initialFrames
+                  : bounds_.minFrames;
+}
+
+void LatencyTuner::raiseFloor(size_t frames) {
+    bounds_.minFrames = std::min(std::max(bounds_.minFrames, frames), bounds_.maxFrames);
+    if (target_ < bounds_.minFrames) {
+        target_ = bounds_.minFrames;
+        changed_ = true;
+    }
+}
+
+void LatencyTuner::onUnderrun(Clock::time_point now) {
+    quietSince_ = now;
+    if (now - lastGrow_ < kUnderrunHoldoff) return;
+    size_t grown = clamp(target_ + bounds_.stepFrames);
+    if (grown == target_) return;
+    growTo(grown, now);
+}
+
+void LatencyTuner::onGap(size_t frames) {
+    peakGapFrames_ = std::max(peakGapFrames_, (double)frames);
+}
+
+bool LatencyTuner::update(Clock::time_point now) {
+    double elapsedSec = std::chrono::duration<double>(now - lastUpdate_).count();
+    lastUpdate_ = now;
+    if (elapsedSec > 0.0) peakGapFrames_ *= std::exp2(-elapsedSec / kGapHalfLifeSec);
+
+    size_t need = clamp(roundUpToStep(needed()));
+    if (need > target_) {
+        growTo(need, now);
+    } else if (now - quietSince_ >= shrinkQuiet_ &&
+               target_ >= need + 2 * bounds_.stepFrames &&
+               target_ - bounds_.stepFrames >= bounds_.minFrames) {
+        // Keep a step of headroom over what the gaps needed, and restart the
+        // quiet period so the next step has to earn it again.
+        target_ -= bounds_.stepFrames;
+        quietSince_ = now;
+        lastShrink_ = now;
+        changed_ = true;
+        shrinks_++;
+    }
+
+    bool changed = changed_;
+    changed_ = false;
+    return changed;
+}
+
+void LatencyTuner::growTo(size_t frames, Clock::time_point now) {
+    if (shrinks_ > 0 && now - lastShrink_ < shrinkQuiet_)
+        shrinkQuiet_ = std::min<Clock::duration>(shrinkQuiet_ * 2, kMaxShrinkQuiet);
+    target_ = frames;
+    lastGrow_ = now;
+    quietSince_ = now;
+    changed_ = true;
+    grows_++;
+}
+
+size_t LatencyTuner::clamp(size_t frames) const {
+    return std::min(std::max(frames, bounds_.minFrames), bounds_.maxFrames);
+}
+
+size_t LatencyTuner::roundUpToStep(size_t frames) const {
+    return (frames + bounds_.stepFrames - 1) / bounds_.stepFrames * bounds_.stepFrames;
+}
+
+size_t LatencyTuner::needed() const {
+    return bounds_.minFrames + (size_t)std::lround(peakGapFrames_);
+}
@@ -0,0 +1,81 @@
+#ifndef LATENCY_TUNER_H
+#define LATENCY_TUNER_H
+
+#include <chrono>
+#include <cstddef>
+
+#include "buffer_plan.h"
+
+// --- Adaptive Latency Tuner ---
+// Chooses the ring fill the bridge aims for in adaptive latency mode. That
+// fill is the pre-roll, the level the ring is re-primed to after an
+// underrun, and the rate controller's set point. It replaces the fixed
+// pre-roll; the ring keeps the preset's size, which is the ceiling.
+//
+// The tuner starts small, at the last value that was stable or at the
+// floor. Evidence that the fill is too thin makes it grow at once: an
+// audible underrun, or a capture period or output write arriving later than
+// the current target leaves room for. It only shrinks a step at a time
+// after a long quiet stretch, and only while a full step of headroom stays
+// above what the recent gaps needed. That gap between grow and shrink is
+// the hysteresis; a shrink that has to be taken back also makes the next
+// one wait longer.
+class LatencyTuner {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Bounds {
+        size_t minFrames;
+        size_t maxFrames;
+        size_t stepFrames;
+    };
+
+    // Floor of 10 ms, ceiling at the pre-roll cap (half the ring), steps of
+    // 2.5 ms.
+    static Bounds boundsFor(const BufferPlan& plan, int sampleRate);
+
+    // `initialFrames` outside the bounds (0 for none) starts at the floor.
+    LatencyTuner(const Bounds& bounds, size_t initialFrames, int sampleRate, Clock::time_point now);
+
+    // Once the capture period is known: the fill has to hold two of them.
+    void raiseFloor(size_t frames);
+
+    // The output ran out of data. Grows by a step, at most once per holdoff
+    // so one dropout counts once.
+    void onUnderrun(Clock::time_point now);
+    // Frames the ring had to cover beyond the normal cadence: a late capture
+    // period or a stalled output write.
+    void onGap(size_t frames);
+
+    // Call periodically. Decays the gap history and applies growth or a
+    // shrink step; true when targetFrames() changed since the last call.
+    bool update(Clock::time_point now);
+
+    size_t targetFrames() const { return target_; }
+    int grows() const { return grows_; }
+    int shrinks() const { return shrinks_; }
+
+private:
+    void growTo(size_t frames, Clock::time_point now);
+    size_t clamp(size_t frames) const;
+    size_t roundUpToStep(size_t frames) const;
+    // Fill the recent gaps call for.
+    size_t needed() const;
+
+    Bounds bounds_;
+    double sampleRate_;
+    size_t target_;
+    bool changed_ = false;
+
+    double peakGapFrames_ = 0.0;  // Decaying maximum
+    Clock::time_point lastUpdate_;
+    Clock::time_point lastGrow_;
+    Clock::time_point quietSince_;  // Last growth, shrink or underrun
+    Clock::time_point lastShrink_;
+    Clock::duration shrinkQuiet_;
+
+    int grows_ = 0;
+    int shrinks_ = 0;
+};
+
+#endif  // LATENCY_TUNER_H
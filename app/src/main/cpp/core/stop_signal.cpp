@@ -0,0 +1,62 @@
+#include "stop_signal.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
+StopSignal bridgeStop;
+
+StopSignal::StopSignal() : fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {}
+
+StopSignal::~StopSignal() {
+    if (fd_ >= 0) close(fd_);
+}
+
+void StopSignal::raise() {
+    if (fd_ >= 0) {
+        uint64_t one = 1;
+        (void)write(fd_, &one, sizeof(one));
+    }
+    std::lock_guard<std::mutex> lock(wakersMutex_);
+    for (StopWaker* waker : wakers_) waker->wake_();
+}
+
+void StopSignal::clear() {
+    if (fd_ < 0) return;
+    // Non-blocking read resets the counter; EAGAIN just means not raised.
+    uint64_t value;
+    (void)read(fd_, &value, sizeof(value));
+}
+
+bool StopSignal::raised() const {
+    if (fd_ < 0) return false;
+    struct pollfd pfd = {fd_, POLLIN, 0};
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN);
+}
+
+bool StopSignal::waitFor(std::chrono::milliseconds timeout) const {
+    if (fd_ < 0) {
+        std::this_thread::sleep_for(timeout);
+        return false;
+    }
+    struct pollfd pfd = {fd_, POLLIN, 0};
+    return poll(&pfd, 1, static_cast<int>(timeout.count())) > 0 && (pfd.revents & POLLIN);
+}
+
+StopWaker::StopWaker(StopSignal& signal, std::function<void()> wake)
+    : signal_(signal), wake_(std::move(wake)) {
+    std::lock_guard<std::mutex> lock(signal_.wakersMutex_);
+    signal_.wakers_.push_back(this);
+    // A stop that landed before registration would otherwise go unseen.
+    if (signal_.raised()) wake_();
+}
+
+StopWaker::~StopWaker() {
+    std::lock_guard<std::mutex> lock(signal_.wakersMutex_);
+    auto& wakers = signal_.wakers_;
+    wakers.erase(std::remove(wakers.begin(), wakers.end(), this), wakers.end());
+}
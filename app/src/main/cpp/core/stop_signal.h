@@ -0,0 +1,65 @@
+#ifndef STOP_SIGNAL_H
+#define STOP_SIGNAL_H
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class StopWaker;
+
+// --- Bridge Stop Signal ---
+// An eventfd that stays readable from raise() until clear(), so any number
+// of poll() loops can include it and all of them wake at once. Waits that
+// cannot poll a fd (futexes, blocking engine calls) register a StopWaker.
+class StopSignal {
+public:
+    StopSignal();
+    ~StopSignal();
+
+    StopSignal(const StopSignal&) = delete;
+    StopSignal& operator=(const StopSignal&) = delete;
+
+    // -1 if eventfd is unavailable; pollers then fall back to their timeouts.
+    int fd() const { return fd_; }
+
+    void raise();
+    // Re-arm before starting a new bridge.
+    void clear();
+
+    bool raised() const;
+
+    // Sleep for `timeout` unless raised first. Returns true if raised, so
+    // backoff loops read `if (bridgeStop.waitFor(...)) break;`.
+    bool waitFor(std::chrono::milliseconds timeout) const;
+
+private:
+    friend class StopWaker;
+
+    int fd_;
+    std::mutex wakersMutex_;
+    std::vector<StopWaker*> wakers_;
+};
+
+// Runs `wake` from raise() for as long as it is alive (and right away if the
+// signal is already raised). It runs on the stopping thread under the
+// signal's lock, so it must only nudge the waiter awake, never block; the
+// destructor guarantees it is not running once the waiter tears down.
+class StopWaker {
+public:
+    StopWaker(StopSignal& signal, std::function<void()> wake);
+    ~StopWaker();
+
+    StopWaker(const StopWaker&) = delete;
+    StopWaker& operator=(const StopWaker&) = delete;
+
+private:
+    friend class StopSignal;
+
+    StopSignal& signal_;
+    std::function<void()> wake_;
+};
+
+extern StopSignal bridgeStop;
+
+#endif  // STOP_SIGNAL_H
@@ -0,0 +1,144 @@
+#include "thread_scheduling.h"
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include "../logging/logging.h"
+#include "bridge.h"
+#include "bridge_stats.h"
+
+static const char* roleName(AudioThreadRole role) {
+    switch (role) {
+        case AudioThreadRole::Capture:
+            return "capture";
+        case AudioThreadRole::Output:
+            return "output";
+        case AudioThreadRole::Mic:
+            return "mic";
+    }
+    return "audio";
+}
+
+// CPUs of the fastest cluster with at least two cores, by cpuinfo_max_freq.
+// Big.LITTLE parts often have a single prime core; two audio threads on one
+// core would only preempt each other. Empty when the SoC is homogeneous or
+// sysfs is unreadable.
+static cpu_set_t performanceCluster(int* count) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    *count = 0;
+
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (cpus <= 0 || cpus > CPU_SETSIZE) return set;
+
+    long freq[CPU_SETSIZE] = {};
+    long lowest = 0;
+    long highest = 0;
+    for (long cpu = 0; cpu < cpus; ++cpu) {
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/cpufreq/cpuinfo_max_freq",
+                 cpu);
+        FILE* file = fopen(path, "re");
+        if (!file) continue;
+        if (fscanf(file, "%ld", &freq[cpu]) != 1) freq[cpu] = 0;
+        fclose(file);
+        if (freq[cpu] <= 0) continue;
+        if (lowest == 0 || freq[cpu] < lowest) lowest = freq[cpu];
+        if (freq[cpu] > highest) highest = freq[cpu];
+    }
+    if (highest == 0 || lowest == highest) return set;
+
+    // Lower the threshold one cluster at a time until it holds two cores.
+    long threshold = highest;
+    while (true) {
+        int members = 0;
+        long next = 0;
+        for (long cpu = 0; cpu < cpus; ++cpu) {
+            if (freq[cpu] >= threshold) {
+                members++;
+            } else if (freq[cpu] > next) {
+                next = freq[cpu];
+            }
+        }
+        if (members >= 2 || next == 0) break;
+        threshold = next;
+    }
+    // The slowest cluster is no better than not pinning at all.
+    if (threshold == lowest) return set;
+
+    for (long cpu = 0; cpu < cpus; ++cpu) {
+        if (freq[cpu] >= threshold) {
+            CPU_SET(cpu, &set);
+            (*count)++;
+        }
+    }
+    return set;
+}
+
+static void formatCpus(const cpu_set_t& set, char* out, size_t size) {
+    size_t used = 0;
+    out[0] = '\0';
+    for (int cpu = 0; cpu < CPU_SETSIZE && used < size; ++cpu) {
+        if (!CPU_ISSET(cpu, &set)) continue;
+        int written = snprintf(out + used, size - used, used ? ",%d" : "%d", cpu);
+        if (written < 0) break;
+        used += static_cast<size_t>(written);
+    }
+}
+
+void promoteAudioThread(AudioThreadRole role) {
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+
+    // Nice first: it is what the thread keeps if SCHED_FIFO is never granted.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(tid), -19);
+
+    char affinity[64] = "any";
+    if (isCpuPinningEnabled) {
+        static std::once_flag detected;
+        static cpu_set_t cluster;
+        static int clusterSize = 0;
+        std::call_once(detected, [] { cluster = performanceCluster(&clusterSize); });
+
+        if (clusterSize == 0) {
+            strcpy(affinity, "any (no faster cluster)");
+        } else if (sched_setaffinity(0, sizeof(cluster), &cluster) == 0) {
+            formatCpus(cluster, affinity, sizeof(affinity));
+        } else {
+            snprintf(affinity, sizeof(affinity), "any (pinning failed: %s)", strerror(errno));
+        }
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = kAudioThreadFifoPriority;
+    if (sched_setscheduler(0, SCHED_FIFO, &param) == 0) {
+        LOGD("[Native] %s thread %d: SCHED_FIFO %d (direct), CPUs %s", roleName(role), tid,
+             kAudioThreadFifoPriority, affinity);
+    } else {
+        // Root helper on the Java side batches all threads that get here.
+        LOGD("[Native] %s thread %d: SCHED_FIFO refused (%s), nice -19, CPUs %s; "
+             "requesting root fallback",
+             roleName(role), tid, strerror(errno), affinity);
+        reportTidToJava(static_cast<int>(tid));
+    }
+    publishThreadScheduling(role);
+}
+
+void publishThreadScheduling(AudioThreadRole role) {
+    int index = static_cast<int>(role);
+    int policy = sched_getscheduler(0);
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    sched_getparam(0, &param);
+
+    int32_t packed = policy < 0 ? -1 : packSchedPolicy(policy, param.sched_priority);
+    bridgeStats.threadSched[index].store(packed, std::memory_order_relaxed);
+    bridgeStats.threadCpu[index].store(sched_getcpu(), std::memory_order_relaxed);
+}
@@ -0,0 +1,33 @@
+#ifndef THREAD_SCHEDULING_H
+#define THREAD_SCHEDULING_H
+
+#include <cstdint>
+
+// --- Audio Thread Scheduling ---
+// Each audio thread promotes itself on entry: nice -19, then SCHED_FIFO via
+// sched_setscheduler(). Only when the kernel refuses (no CAP_SYS_NICE and
+// no RLIMIT_RTPRIO, the usual case for an app) is the thread handed to the
+// Java side, which batches every pending thread into a single root shell.
+// With CPU pinning enabled the thread is also bound to the fastest cluster
+// that has at least two cores, so capture and output share a cluster and
+// its caches.
+enum class AudioThreadRole : int {
+    Capture = 0,
+    Output = 1,
+    Mic = 2,
+};
+
+static constexpr int kAudioThreadRoles = 3;
+static constexpr int kAudioThreadFifoPriority = 50;
+
+void promoteAudioThread(AudioThreadRole role);
+
+// Re-read the calling thread's policy and CPU into bridgeStats. Cheap (two
+// syscalls); call at the stats interval so a root fallback that lands later
+// shows up too.
+void publishThreadScheduling(AudioThreadRole role);
+
+// Packs policy and priority the way bridgeStats stores them.
+inline int32_t packSchedPolicy(int policy, int priority) { return (policy << 8) | priority; }
+
+#endif  // THREAD_SCHEDULING_H
@@ -0,0 +1,101 @@
+#ifndef ADAPTIVE_RESAMPLER_H
+#define ADAPTIVE_RESAMPLER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "../audio/audio_frame.h"
+
+// --- Adaptive Asynchronous Resampler ---
+// Streams frames at a continuously adjustable ratio close to 1.0 to absorb
+// the drift between the USB host clock and the output clock. Uses 4-point
+// cubic Hermite interpolation, which is transparent for the +-1000 ppm range
+// it is driven in, and only adds two frames of latency.
+template <typename Frame>
+class AdaptiveResampler {
+    using Sample = typename Frame::SampleType;
+    static constexpr int kChannels = Frame::kChannels;
+    static_assert(std::is_arithmetic<Sample>::value, "resampler needs arithmetic samples");
+
+public:
+    // Input frames consumed per output frame. > 1.0 drains the source
+    // faster than real time, < 1.0 slower.
+    void setRatio(double ratio) { step_ = ratio; }
+    double ratio() const { return step_; }
+
+    // Forget history, e.g. after an underrun gap.
+    void reset() {
+        std::fill(&history_[0][0], &history_[0][0] + 4 * kChannels, 0.0f);
+        phase_ = 1.0;
+        primed_ = 0;
+    }
+
+    // Produce up to `outFrames` from up to `inFrames`. Stops as soon as
+    // either side runs out; call again with the next input span to continue.
+    // Returns frames produced; `*consumed` is input frames used.
+    size_t process(const Frame* in, size_t inFrames, Frame* out, size_t outFrames,
+                   size_t* consumed) {
+        size_t used = 0;
+        size_t produced = 0;
+        while (produced < outFrames) {
+            if (phase_ >= 1.0) {
+                if (used == inFrames) break;
+                push(in[used++]);
+                phase_ -= 1.0;
+                continue;
+            }
+            if (primed_ < 4) {
+                // Not enough history yet: skip ahead without output.
+                phase_ = 1.0;
+                continue;
+            }
+            interpolate(static_cast<float>(phase_), out[produced++]);
+            phase_ += step_;
+        }
+        *consumed = used;
+        return produced;
+    }
+
+private:
+    void push(const Frame& frame) {
+        for (int h = 0; h < 3; ++h) {
+            for (int c = 0; c < kChannels; ++c) history_[h][c] = history_[h + 1][c];
+        }
+        for (int c = 0; c < kChannels; ++c) {
+            history_[3][c] = static_cast<float>(frame.samples[c]);
+        }
+        if (primed_ < 4) primed_++;
+    }
+
+    // Hermite spline between history_[1] and history_[2] at t in [0, 1).
+    void interpolate(float t, Frame& out) const {
+        for (int c = 0; c < kChannels; ++c) {
+            float xm1 = history_[0][c];
+            float x0 = history_[1][c];
+            float x1 = history_[2][c];
+            float x2 = history_[3][c];
+            float c1 = 0.5f * (x1 - xm1);
+            float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+            float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+            out.samples[c] = toSample(((c3 * t + c2) * t + c1) * t + x0);
+        }
+    }
+
+    static Sample toSample(float value) {
+        if (std::is_integral<Sample>::value) {
+            value = std::min(value, static_cast<float>(std::numeric_limits<Sample>::max()));
+            value = std::max(value, static_cast<float>(std::numeric_limits<Sample>::min()));
+            return static_cast<Sample>(value + (value >= 0.0f ? 0.5f : -0.5f));
+        }
+        return static_cast<Sample>(value);
+    }
+
+    float history_[4][kChannels] = {};
+    double phase_ = 1.0;
+    double step_ = 1.0;
+    int primed_ = 0;
+};
+
+#endif  // ADAPTIVE_RESAMPLER_H
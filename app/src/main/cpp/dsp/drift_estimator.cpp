@@ -0,0 +1,71 @@
+#include "drift_estimator.h"
+
+#include <cmath>
+
+namespace {
+
+// Window span needed before a rate is trusted.
+constexpr int64_t kMinSpanNs = 5000000000LL;
+
+// Estimates further out than this are a glitch (e.g. a position jump that
+// was not reset), not clock drift.
+constexpr double kMaxPlausiblePpm = 5000.0;
+
+// Per-point EMA weight (~10 s time constant at one point per second).
+constexpr double kSmoothing = 0.1;
+
+}  // namespace
+
+bool ClockRateTracker::add(int64_t frames, int64_t timeNs) {
+    if (count_ > 0 && timeNs - times_[newest_] < kSpacingNs) return false;
+
+    newest_ = (newest_ + 1) % kPoints;
+    frames_[newest_] = frames;
+    times_[newest_] = timeNs;
+    if (count_ < kPoints) count_++;
+    return true;
+}
+
+double ClockRateTracker::rate() const {
+    if (count_ < 2) return 0.0;
+
+    int oldest = (newest_ - count_ + 1 + kPoints) % kPoints;
+    int64_t span = times_[newest_] - times_[oldest];
+    if (span < kMinSpanNs) return 0.0;
+    return static_cast<double>(frames_[newest_] - frames_[oldest]) * 1e9 /
+           static_cast<double>(span);
+}
+
+void DriftEstimator::addCaptureSample(int64_t frames, int64_t timeNs) {
+    if (capture_.add(frames, timeNs)) {
+        capture_rate_.store(capture_.rate(), std::memory_order_relaxed);
+    }
+}
+
+void DriftEstimator::resetCapture() {
+    capture_.reset();
+    capture_rate_.store(0.0, std::memory_order_relaxed);
+}
+
+void DriftEstimator::addOutputSample(int64_t frames, int64_t timeNs) {
+    if (!output_.add(frames, timeNs)) return;
+
+    double captureRate = capture_rate_.load(std::memory_order_relaxed);
+    double outputRate = output_.rate();
+    if (captureRate <= 0.0 || outputRate <= 0.0) return;
+
+    double ppm = (captureRate / outputRate - 1.0) * 1e6;
+    if (std::fabs(ppm) > kMaxPlausiblePpm) return;
+
+    if (!has_estimate_) {
+        smoothed_ppm_ = ppm;
+        has_estimate_ = true;
+    } else {
+        smoothed_ppm_ += kSmoothing * (ppm - smoothed_ppm_);
+    }
+    ppm_.store(smoothed_ppm_, std::memory_order_relaxed);
+}
+
+void DriftEstimator::resetOutput() {
+    output_.reset();
+}
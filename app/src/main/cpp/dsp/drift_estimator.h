@@ -0,0 +1,64 @@
+#ifndef DRIFT_ESTIMATOR_H
+#define DRIFT_ESTIMATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+// --- Clock Rate Tracker ---
+// Rate of one clock in frames per second of CLOCK_MONOTONIC, from
+// (position, timestamp) pairs kept about a second apart over a ~30 s window.
+// A long window averages out USB packet and scheduling jitter.
+class ClockRateTracker {
+public:
+    void reset() { count_ = 0; }
+
+    // Records the pair if at least the point spacing has passed since the
+    // previous one. Returns true when a point was recorded.
+    bool add(int64_t frames, int64_t timeNs);
+
+    // Frames per second across the window; 0 until it spans a few seconds.
+    double rate() const;
+
+private:
+    static constexpr int kPoints = 32;
+    static constexpr int64_t kSpacingNs = 1000000000;
+
+    int64_t frames_[kPoints] = {};
+    int64_t times_[kPoints] = {};
+    int count_ = 0;
+    int newest_ = -1;
+};
+
+// --- Host/Output Drift Estimator ---
+// Compares how fast the USB host delivers frames (capture PCM hardware
+// timestamps) with how fast the output consumes them (engine presentation
+// timestamps). Positive ppm means the host runs fast and the ring would
+// fill up without correction.
+class DriftEstimator {
+public:
+    // Capture thread. `frames` is the PCM position at `timeNs`.
+    void addCaptureSample(int64_t frames, int64_t timeNs);
+    // Capture thread, after an xrun or restart broke the position count.
+    void resetCapture();
+
+    // Output thread. `frames` is the presented position at `timeNs`.
+    void addOutputSample(int64_t frames, int64_t timeNs);
+    // Output thread, after a gap in the output position.
+    void resetOutput();
+
+    // Any thread: smoothed offset in ppm, NaN until both sides have enough
+    // history.
+    double ppm() const { return ppm_.load(std::memory_order_relaxed); }
+
+private:
+    ClockRateTracker capture_;  // Capture thread only
+    ClockRateTracker output_;   // Output thread only
+
+    std::atomic<double> capture_rate_{0.0};
+    std::atomic<double> ppm_{std::numeric_limits<double>::quiet_NaN()};
+    double smoothed_ppm_ = 0.0;  // Output thread only
+    bool has_estimate_ = false;  // Output thread only
+};
+
+#endif  // DRIFT_ESTIMATOR_H
@@ -0,0 +1,58 @@
+#include "rate_controller.h"
+
+#include <algorithm>
+
+namespace {
+
+// Fill is sampled once per chunk and jumps by a whole capture period on
+// every commit; average over ~0.5 s so the controller sees the trend.
+constexpr double kFillSmoothingSeconds = 0.5;
+
+// Gains on the fill error in seconds of audio, so the loop behaves the same
+// at every sample rate. A correction of x ppm moves the fill by x us per
+// second: Kp = 1e5 gives a ~10 s time constant, and Ki = Kp^2 / 4e6 makes
+// the loop critically damped, so the integral settles on the real clock
+// offset without ringing.
+constexpr double kProportionalPpmPerSecond = 1e5;
+constexpr double kIntegralPpmPerSecond2 = 2500.0;
+
+}  // namespace
+
+RateController::RateController(size_t targetFrames, int sampleRate, double maxPpm)
+    : target_(static_cast<double>(targetFrames)),
+      sample_rate_(sampleRate > 0 ? sampleRate : 48000),
+      max_ppm_(maxPpm),
+      smoothed_fill_(target_) {}
+
+void RateController::reset() {
+    smoothed_fill_ = target_;
+    integral_ = 0.0;
+    ppm_ = 0.0;
+}
+
+void RateController::setTarget(size_t targetFrames) {
+    target_ = static_cast<double>(targetFrames);
+}
+
+double RateController::update(size_t fillFrames, size_t elapsedFrames) {
+    double dt = static_cast<double>(elapsedFrames) / sample_rate_;
+    double alpha = dt / (kFillSmoothingSeconds + dt);
+    smoothed_fill_ += alpha * (static_cast<double>(fillFrames) - smoothed_fill_);
+
+    double error = (smoothed_fill_ - target_) / sample_rate_;
+    double proportional = kProportionalPpmPerSecond * error;
+
+    // Anti-windup: stop integrating once the output saturates in the
+    // direction the error is still pushing.
+    double candidate = integral_ + kIntegralPpmPerSecond2 * error * dt;
+    double output = proportional + candidate;
+    if (output > max_ppm_ && error > 0.0) {
+        candidate = integral_;
+    } else if (output < -max_ppm_ && error < 0.0) {
+        candidate = integral_;
+    }
+    integral_ = std::max(-max_ppm_, std::min(max_ppm_, candidate));
+
+    ppm_ = std::max(-max_ppm_, std::min(max_ppm_, proportional + integral_));
+    return ppm_;
+}
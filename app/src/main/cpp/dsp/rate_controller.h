@@ -0,0 +1,42 @@
+#ifndef RATE_CONTROLLER_H
+#define RATE_CONTROLLER_H
+
+#include <cstddef>
+
+// --- Ring Fill Rate Controller ---
+// PI controller that turns the ring fill level into a resampling correction
+// in ppm. Positive output means the ring is filling up (host faster than the
+// output clock) and the consumer should drain slightly faster.
+class RateController {
+public:
+    // `targetFrames` is the fill to hold.
+    RateController(size_t targetFrames, int sampleRate, double maxPpm = 1000.0);
+
+    void reset();
+
+    // Moves the fill to hold. Keeps the integral, which tracks the clock
+    // offset rather than the fill, so the fill walks over to the new target
+    // at the loop's own pace.
+    void setTarget(size_t targetFrames);
+
+    // Feed the current fill after `elapsedFrames` of output. Returns the new
+    // correction in ppm, clamped to +-maxPpm.
+    double update(size_t fillFrames, size_t elapsedFrames);
+
+    double ppm() const { return ppm_; }
+    double smoothedFill() const { return smoothed_fill_; }
+
+    // Ratio to hand to AdaptiveResampler::setRatio().
+    double ratio() const { return 1.0 + ppm_ * 1e-6; }
+
+private:
+    double target_;
+    double sample_rate_;
+    double max_ppm_;
+
+    double smoothed_fill_;
+    double integral_ = 0.0;
+    double ppm_ = 0.0;
+};
+
+#endif  // RATE_CONTROLLER_H
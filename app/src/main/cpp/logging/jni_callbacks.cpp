@@ -0,0 +1,101 @@
+#include "jni_callbacks.h"
+
+#include <android/log.h>
+
+#include "logging.h"
+
+JavaVM* javaVM = nullptr;
+std::atomic<jobject> serviceObj{nullptr};
+JniCallbacks jniCallbacks;
+
+namespace {
+
+// Detaches a thread attached by attachedEnv() when it exits.
+struct ThreadAttachment {
+    JNIEnv* env = nullptr;
+    bool attachedHere = false;
+
+    ~ThreadAttachment() {
+        if (attachedHere && javaVM) {
+            javaVM->DetachCurrentThread();
+        }
+    }
+};
+
+thread_local ThreadAttachment threadAttachment;
+
+// Runs on the log drainer.
+void deleteServiceRef(void* ref) {
+    JNIEnv* env = attachedEnv();
+    if (env) env->DeleteGlobalRef(static_cast<jobject>(ref));
+}
+
+}  // namespace
+
+bool registerJniCallbacks(JNIEnv* env) {
+    jclass local = env->FindClass("com/flopster101/usbaudiobridge/AudioService");
+    if (!local) {
+        clearJniException(env);
+        __android_log_print(ANDROID_LOG_ERROR, TAG, "[Native] AudioService class not found");
+        return false;
+    }
+    jniCallbacks.serviceClass = static_cast<jclass>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+
+    jclass cls = jniCallbacks.serviceClass;
+    jniCallbacks.onNativeLog = env->GetMethodID(cls, "onNativeLog", "(Ljava/lang/String;)V");
+    jniCallbacks.onNativeThreadStart = env->GetMethodID(cls, "onNativeThreadStart", "(I)V");
+    jniCallbacks.onNativeError = env->GetMethodID(cls, "onNativeError", "(Ljava/lang/String;)V");
+    jniCallbacks.onOutputDisconnect = env->GetMethodID(cls, "onOutputDisconnect", "()V");
+    jniCallbacks.onNativeState = env->GetMethodID(cls, "onNativeState", "(I)V");
+    jniCallbacks.onCaptureLayout = env->GetMethodID(cls, "onCaptureLayout", "(II)V");
+    jniCallbacks.onLatencyTarget = env->GetMethodID(cls, "onLatencyTarget", "(I)V");
+    jniCallbacks.onHostRateChange = env->GetMethodID(cls, "onHostRateChange", "(I)V");
+    jniCallbacks.initAudioTrack = env->GetMethodID(cls, "initAudioTrack", "(II)I");
+    jniCallbacks.startAudioTrack = env->GetMethodID(cls, "startAudioTrack", "()V");
+    jniCallbacks.writeAudioTrack =
+        env->GetMethodID(cls, "writeAudioTrack", "(Ljava/nio/ByteBuffer;I)V");
+    jniCallbacks.stopAudioTrack = env->GetMethodID(cls, "stopAudioTrack", "()V");
+    jniCallbacks.releaseAudioTrack = env->GetMethodID(cls, "releaseAudioTrack", "()V");
+    jniCallbacks.getAudioTrackHeadPosition =
+        env->GetMethodID(cls, "getAudioTrackHeadPosition", "()I");
+
+    // A failed GetMethodID leaves NoSuchMethodError pending.
+    if (clearJniException(env)) {
+        __android_log_print(ANDROID_LOG_ERROR, TAG,
+                            "[Native] Some AudioService callbacks are missing");
+        return false;
+    }
+    return true;
+}
+
+void setServiceObject(JNIEnv* env, jobject service) {
+    jobject current = serviceObj.load();
+    if (current && env->IsSameObject(current, service)) return;
+
+    jobject previous = serviceObj.exchange(env->NewGlobalRef(service));
+    if (previous) runOnLogDrainer(deleteServiceRef, previous);
+}
+
+JNIEnv* attachedEnv() {
+    if (threadAttachment.env) return threadAttachment.env;
+    if (!javaVM) return nullptr;
+
+    JNIEnv* env = nullptr;
+    int status = javaVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
+    if (status == JNI_EDETACHED) {
+        if (javaVM->AttachCurrentThread(&env, nullptr) != JNI_OK) return nullptr;
+        threadAttachment.attachedHere = true;
+    } else if (status != JNI_OK) {
+        return nullptr;
+    }
+    threadAttachment.env = env;
+    return env;
+}
+
+bool clearJniException(JNIEnv* env) {
+    if (!env->ExceptionCheck()) return false;
+    env->ExceptionDescribe();
+    env->ExceptionClear();
+    return true;
+}
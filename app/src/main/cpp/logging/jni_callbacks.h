@@ -0,0 +1,60 @@
+#ifndef JNI_CALLBACKS_H
+#define JNI_CALLBACKS_H
+
+#include <jni.h>
+
+#include <atomic>
+
+// Logcat tag for everything the app logs from native code
+#define TAG "UsbAudioNative"
+
+// JNI Globals
+extern JavaVM* javaVM;
+// Global ref to the running AudioService. The log drainer outlives every
+// bridge, so it is only replaced through setServiceObject().
+extern std::atomic<jobject> serviceObj;
+
+// --- JNI Callback Registry ---
+// AudioService class and method IDs, resolved once in JNI_OnLoad. Method IDs
+// stay valid while the class is loaded, which the global class ref ensures.
+struct JniCallbacks {
+    jclass serviceClass = nullptr;  // Global ref
+
+    jmethodID onNativeLog = nullptr;
+    jmethodID onNativeThreadStart = nullptr;
+    jmethodID onNativeError = nullptr;
+    jmethodID onOutputDisconnect = nullptr;
+    jmethodID onNativeState = nullptr;
+    jmethodID onCaptureLayout = nullptr;
+    jmethodID onLatencyTarget = nullptr;
+    jmethodID onHostRateChange = nullptr;
+
+    // JavaAudioTrackEngine
+    jmethodID initAudioTrack = nullptr;
+    jmethodID startAudioTrack = nullptr;
+    jmethodID writeAudioTrack = nullptr;
+    jmethodID stopAudioTrack = nullptr;
+    jmethodID releaseAudioTrack = nullptr;
+    jmethodID getAudioTrackHeadPosition = nullptr;
+};
+
+extern JniCallbacks jniCallbacks;
+
+// Resolve everything above. Call from JNI_OnLoad, where FindClass sees the
+// app's class loader. Returns false if any lookup failed.
+bool registerJniCallbacks(JNIEnv* env);
+
+// Point serviceObj at `service`, keeping the current ref if it is the same
+// object. A replaced ref is deleted by the log drainer after the lines
+// queued before the swap, which it may still be sending to that service.
+void setServiceObject(JNIEnv* env, jobject service);
+
+// JNIEnv for the calling thread. A native thread is attached on first use
+// and stays attached until it exits, instead of attach/detach per call.
+JNIEnv* attachedEnv();
+
+// Drop a pending Java exception so later JNI calls on this thread stay valid.
+// Returns true if there was one.
+bool clearJniException(JNIEnv* env);
+
+#endif  // JNI_CALLBACKS_H
@@ -0,0 +1,92 @@
+#include "jni_log_sink.h"
+
+#include <android/log.h>
+
+#include "jni_callbacks.h"
+
+void JniLogSink::onDrainerStart() {
+    // Attached once for the life of the process instead of per line; as a
+    // daemon since the drainer never exits.
+    JNIEnv* env = nullptr;
+    if (javaVM && javaVM->AttachCurrentThreadAsDaemon(&env, nullptr) == JNI_OK) {
+        drainerEnv_ = attachedEnv();
+    }
+}
+
+void JniLogSink::writeLog(int priority, const char* text) {
+    __android_log_print(priority, TAG, "%s", text);
+
+    JNIEnv* env = drainerEnv_;
+    jobject service = serviceObj.load();
+    if (!env || !service || !jniCallbacks.onNativeLog) return;
+
+    jstring jLog = env->NewStringUTF(text);
+    env->CallVoidMethod(service, jniCallbacks.onNativeLog, jLog);
+    env->DeleteLocalRef(jLog);
+    clearJniException(env);
+}
+
+void JniLogSink::onThreadStart(int tid) {
+    JNIEnv* env = attachedEnv();
+    jobject service = serviceObj.load();
+    if (!env || !service || !jniCallbacks.onNativeThreadStart) return;
+
+    env->CallVoidMethod(service, jniCallbacks.onNativeThreadStart, tid);
+    clearJniException(env);
+}
+
+void JniLogSink::onError(const char* message) {
+    JNIEnv* env = attachedEnv();
+    jobject service = serviceObj.load();
+    if (!env || !service || !jniCallbacks.onNativeError) return;
+
+    jstring jMsg = env->NewStringUTF(message);
+    env->CallVoidMethod(service, jniCallbacks.onNativeError, jMsg);
+    env->DeleteLocalRef(jMsg);
+    clearJniException(env);
+}
+
+void JniLogSink::onOutputDisconnect() {
+    JNIEnv* env = attachedEnv();
+    jobject service = serviceObj.load();
+    if (!env || !service || !jniCallbacks.onOutputDisconnect) return;
+
+    env->CallVoidMethod(service, jniCallbacks.onOutputDisconnect);
+    clearJniException(env);
+}
+
+void JniLogSink::onState(int stateCode) {
+    JNIEnv* env = attachedEnv();
+    jobject service = serviceObj.load();
+    if (!env || !service || !jniCallbacks.onNativeState) return;
+
+    env->CallVoidMethod(service, jniCallbacks.onNativeState, stateCode);
+    clearJniException(env);
+}
+
+void JniLogSink::onHostRateChange(int rate) {
+    JNIEnv* env = attachedEnv();
+    jobject service = serviceObj.load();
+    if (!env || !service || !jniCallbacks.onHostRateChange) return;
+
+    env->CallVoidMethod(service, jniCallbacks.onHostRateChange, rate);
+    clearJniException(env);
+}
+
+void JniLogSink::onCaptureLayout(int periodFrames, int periodCount) {
+    JNIEnv* env = attachedEnv();
+    jobject service = serviceObj.load();
+    if (!env || !service || !jniCallbacks.onCaptureLayout) return;
+
+    env->CallVoidMethod(service, jniCallbacks.onCaptureLayout, periodFrames, periodCount);
+    clearJniException(env);
+}
+
+void JniLogSink::onLatencyTarget(int targetFrames) {
+    JNIEnv* env = attachedEnv();
+    jobject service = serviceObj.load();
+    if (!env || !service || !jniCallbacks.onLatencyTarget) return;
+
+    env->CallVoidMethod(service, jniCallbacks.onLatencyTarget, targetFrames);
+    clearJniException(env);
+}
@@ -0,0 +1,29 @@
+#ifndef JNI_LOG_SINK_H
+#define JNI_LOG_SINK_H
+
+#include <jni.h>
+
+#include "logging.h"
+
+// --- JNI Log Sink ---
+// Log lines go to Logcat and AudioService.onNativeLog; status reports become
+// the matching AudioService callbacks from jniCallbacks.
+class JniLogSink : public LogSink {
+public:
+    void onDrainerStart() override;
+    void writeLog(int priority, const char* text) override;
+
+    void onThreadStart(int tid) override;
+    void onError(const char* message) override;
+    void onOutputDisconnect() override;
+    void onState(int stateCode) override;
+    void onHostRateChange(int rate) override;
+    void onCaptureLayout(int periodFrames, int periodCount) override;
+    void onLatencyTarget(int targetFrames) override;
+
+private:
+    // The drainer's env, attached for the life of the process.
+    JNIEnv* drainerEnv_ = nullptr;
+};
+
+#endif  // JNI_LOG_SINK_H
@@ -0,0 +1,362 @@
+#include "log_queue.h"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+enum class Length { kNone, kHH, kH, kL, kLL, kZ, kJ, kT, kBigL };
+
+// One printf conversion, parsed from just after its '%'.
+struct Spec {
+    const char* flags;
+    size_t flagsLength;
+    const char* width;  // Digits, or "*"
+    size_t widthLength;
+    const char* precision;  // After the '.', or "*"; nullptr if none
+    size_t precisionLength;
+    Length length;
+    char conversion;
+    const char* next;
+};
+
+size_t spanOf(const char* p, const char* set) { return strspn(p, set); }
+
+// False for conversions the queue does not capture (%n, %ls, ...).
+bool parseSpec(const char* p, Spec* spec) {
+    spec->flags = p;
+    spec->flagsLength = spanOf(p, "-+ #0");
+    p += spec->flagsLength;
+
+    spec->width = p;
+    spec->widthLength = (*p == '*') ? 1 : spanOf(p, "0123456789");
+    p += spec->widthLength;
+
+    spec->precision = nullptr;
+    spec->precisionLength = 0;
+    if (*p == '.') {
+        p++;
+        spec->precision = p;
+        spec->precisionLength = (*p == '*') ? 1 : spanOf(p, "0123456789");
+        p += spec->precisionLength;
+    }
+
+    spec->length = Length::kNone;
+    if (p[0] == 'h' && p[1] == 'h') {
+        spec->length = Length::kHH;
+        p += 2;
+    } else if (p[0] == 'l' && p[1] == 'l') {
+        spec->length = Length::kLL;
+        p += 2;
+    } else if (*p == 'h' || *p == 'l' || *p == 'z' || *p == 'j' || *p == 't' || *p == 'L') {
+        static const Length kLengths[] = {Length::kH, Length::kL, Length::kZ,
+                                          Length::kJ, Length::kT, Length::kBigL};
+        spec->length = kLengths[strchr("hlzjtL", *p) - "hlzjtL"];
+        p++;
+    }
+
+    spec->conversion = *p;
+    spec->next = p + 1;
+    if (*p == '\0' || !strchr("diuoxXcsfFeEgGaAp", *p)) return false;
+    // Wide characters and strings would need their own copies.
+    return !((*p == 'c' || *p == 's') && spec->length != Length::kNone);
+}
+
+long long signedArg(Length length, va_list* args) {
+    switch (length) {
+        case Length::kHH: return (signed char)va_arg(*args, int);
+        case Length::kH: return (short)va_arg(*args, int);
+        case Length::kL: return va_arg(*args, long);
+        case Length::kLL: return va_arg(*args, long long);
+        case Length::kZ:
+        case Length::kT: return va_arg(*args, ptrdiff_t);
+        case Length::kJ: return va_arg(*args, intmax_t);
+        default: return va_arg(*args, int);
+    }
+}
+
+unsigned long long unsignedArg(Length length, va_list* args) {
+    switch (length) {
+        case Length::kHH: return (unsigned char)va_arg(*args, unsigned int);
+        case Length::kH: return (unsigned short)va_arg(*args, unsigned int);
+        case Length::kL: return va_arg(*args, unsigned long);
+        case Length::kLL: return va_arg(*args, unsigned long long);
+        case Length::kZ: return va_arg(*args, size_t);
+        case Length::kT: return (size_t)va_arg(*args, ptrdiff_t);
+        case Length::kJ: return va_arg(*args, uintmax_t);
+        default: return va_arg(*args, unsigned int);
+    }
+}
+
+// Appends to a bounded buffer; `*used` stops at size - 1.
+void append(char* out, size_t size, size_t* used, const char* text, size_t length) {
+    size_t n = std::min(length, size - 1 - *used);
+    memcpy(out + *used, text, n);
+    *used += n;
+    out[*used] = '\0';
+}
+
+}  // namespace
+
+LogQueue::LogQueue() {
+    for (size_t i = 0; i < kCapacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+LogQueue::Slot* LogQueue::claim(size_t* pos) {
+    *pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        Slot* slot = &slots_[*pos & (kCapacity - 1)];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(*pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(*pos, *pos + 1, std::memory_order_relaxed)) {
+                return slot;
+            }
+        } else if (diff < 0) {
+            // Drainer is a full lap behind.
+            return nullptr;
+        } else {
+            *pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void LogQueue::publish(Slot* slot, size_t pos) {
+    slot->sequence.store(pos + 1, std::memory_order_seq_cst);
+
+    // Same handshake as RingBuffer: only enter the kernel while the drainer
+    // is actually asleep.
+    if (waiters_.load(std::memory_order_seq_cst) != 0) {
+        signal_.fetch_add(1, std::memory_order_seq_cst);
+        syscall(SYS_futex, &signal_, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+}
+
+bool LogQueue::push(int priority, const char* fmt, va_list args) {
+    size_t pos;
+    Slot* slot = claim(&pos);
+    if (!slot) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    slot->entry.priority = priority;
+    slot->entry.call = nullptr;
+    capture(&slot->entry, fmt, args);
+    publish(slot, pos);
+    return true;
+}
+
+bool LogQueue::pushCall(void (*call)(void*), void* arg) {
+    size_t pos;
+    Slot* slot = claim(&pos);
+    if (!slot) return false;
+
+    slot->entry.call = call;
+    slot->entry.callArg = arg;
+    publish(slot, pos);
+    return true;
+}
+
+bool LogQueue::pop(Record* out) {
+    Slot& slot = slots_[dequeue_pos_ & (kCapacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) return false;
+
+    // Formatting reads only the copy, so the slot goes back to producers
+    // right away.
+    Entry entry = slot.entry;
+    slot.sequence.store(dequeue_pos_ + kCapacity, std::memory_order_release);
+    dequeue_pos_++;
+
+    out->call = entry.call;
+    out->callArg = entry.callArg;
+    if (entry.call) {
+        out->text[0] = '\0';
+        return true;
+    }
+    out->priority = entry.priority;
+    format(entry, out->text, kTextSize);
+    return true;
+}
+
+void LogQueue::capture(Entry* entry, const char* fmt, va_list args) {
+    va_list original;
+    va_copy(original, args);
+    va_list rest;
+    va_copy(rest, args);
+
+    entry->fmt = fmt;
+    entry->argCount = 0;
+    entry->strings[kStringBytes - 1] = '\0';
+    size_t stringsUsed = 0;
+    bool captured = true;
+
+    auto add = [&](Arg::Kind kind) -> Arg* {
+        if (entry->argCount == kMaxArgs) {
+            captured = false;
+            return nullptr;
+        }
+        Arg* arg = &entry->args[entry->argCount++];
+        arg->kind = kind;
+        return arg;
+    };
+
+    for (const char* p = fmt; captured && *p;) {
+        if (*p++ != '%') continue;
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        Spec spec;
+        if (!parseSpec(p, &spec)) {
+            captured = false;
+            break;
+        }
+        p = spec.next;
+
+        Arg* arg;
+        if (*spec.width == '*' && (arg = add(Arg::kSigned))) arg->i = va_arg(rest, int);
+        if (spec.precision && *spec.precision == '*' && (arg = add(Arg::kSigned)))
+            arg->i = va_arg(rest, int);
+
+        switch (spec.conversion) {
+            case 'd':
+            case 'i':
+                if ((arg = add(Arg::kSigned))) arg->i = signedArg(spec.length, &rest);
+                break;
+            case 'c':
+                if ((arg = add(Arg::kSigned))) arg->i = va_arg(rest, int);
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                if ((arg = add(Arg::kUnsigned))) arg->u = unsignedArg(spec.length, &rest);
+                break;
+            case 'p':
+                if ((arg = add(Arg::kPointer))) arg->p = va_arg(rest, void*);
+                break;
+            case 's':
+                if ((arg = add(Arg::kString))) {
+                    // The caller's buffer may be gone by the time the drainer
+                    // runs. The last byte of `strings` is a shared empty
+                    // string once the space runs out.
+                    const char* text = va_arg(rest, const char*);
+                    if (!text) text = "(null)";
+                    size_t length = strnlen(text, kStringBytes - 1 - stringsUsed);
+                    arg->offset = stringsUsed;
+                    memcpy(entry->strings + stringsUsed, text, length);
+                    entry->strings[stringsUsed + length] = '\0';
+                    stringsUsed = std::min(stringsUsed + length + 1, kStringBytes - 1);
+                }
+                break;
+            default:  // Floating point
+                if ((arg = add(Arg::kDouble))) {
+                    arg->d = (spec.length == Length::kBigL) ? (double)va_arg(rest, long double)
+                                                            : va_arg(rest, double);
+                }
+                break;
+        }
+    }
+
+    if (!captured) {
+        entry->fmt = nullptr;
+        vsnprintf(entry->strings, kStringBytes, fmt, original);
+    }
+    va_end(rest);
+    va_end(original);
+}
+
+void LogQueue::format(const Entry& entry, char* out, size_t size) {
+    size_t used = 0;
+    out[0] = '\0';
+    if (!entry.fmt) {
+        append(out, size, &used, entry.strings, strnlen(entry.strings, kStringBytes));
+        return;
+    }
+
+    size_t next = 0;
+    const char* p = entry.fmt;
+    while (*p && used < size - 1) {
+        const char* percent = strchr(p, '%');
+        if (!percent) {
+            append(out, size, &used, p, strlen(p));
+            break;
+        }
+        append(out, size, &used, p, percent - p);
+        p = percent + 1;
+        if (*p == '%') {
+            append(out, size, &used, "%", 1);
+            p++;
+            continue;
+        }
+        Spec spec;
+        parseSpec(p, &spec);  // Succeeded in capture()
+        p = spec.next;
+
+        // Rebuild the conversion with '*' resolved and a length modifier that
+        // matches how the argument was stored.
+        char conversion[48];
+        int n = snprintf(conversion, sizeof(conversion), "%%%.*s", (int)spec.flagsLength,
+                         spec.flags);
+        if (*spec.width == '*') {
+            n += snprintf(conversion + n, sizeof(conversion) - n, "%lld", entry.args[next++].i);
+        } else {
+            n += snprintf(conversion + n, sizeof(conversion) - n, "%.*s", (int)spec.widthLength,
+                          spec.width);
+        }
+        if (spec.precision && *spec.precision == '*') {
+            n += snprintf(conversion + n, sizeof(conversion) - n, ".%lld",
+                          entry.args[next++].i);
+        } else if (spec.precision) {
+            n += snprintf(conversion + n, sizeof(conversion) - n, ".%.*s",
+                          (int)spec.precisionLength, spec.precision);
+        }
+
+        const Arg& arg = entry.args[next++];
+        bool integer = arg.kind == Arg::kSigned || arg.kind == Arg::kUnsigned;
+        snprintf(conversion + n, sizeof(conversion) - n, "%s%c",
+                 (integer && spec.conversion != 'c') ? "ll" : "", spec.conversion);
+
+        char* dest = out + used;
+        size_t room = size - used;
+        int written = 0;
+        switch (arg.kind) {
+            case Arg::kSigned:
+                written = (spec.conversion == 'c') ? snprintf(dest, room, conversion, (int)arg.i)
+                                                   : snprintf(dest, room, conversion, arg.i);
+                break;
+            case Arg::kUnsigned: written = snprintf(dest, room, conversion, arg.u); break;
+            case Arg::kDouble: written = snprintf(dest, room, conversion, arg.d); break;
+            case Arg::kPointer: written = snprintf(dest, room, conversion, arg.p); break;
+            case Arg::kString:
+                written = snprintf(dest, room, conversion, entry.strings + arg.offset);
+                break;
+        }
+        if (written > 0) used = std::min(used + (size_t)written, size - 1);
+    }
+}
+
+void LogQueue::waitForRecords(std::chrono::milliseconds timeout) {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t signal = signal_.load(std::memory_order_seq_cst);
+    Slot& next = slots_[dequeue_pos_ & (kCapacity - 1)];
+    if (next.sequence.load(std::memory_order_seq_cst) != dequeue_pos_ + 1) {
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+        ts.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+        syscall(SYS_futex, &signal_, FUTEX_WAIT_PRIVATE, signal, &ts, nullptr, 0);
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,102 @@
+#ifndef LOG_QUEUE_H
+#define LOG_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+// --- Lock-Free Log Queue (MPSC) ---
+// Producers store the format pointer and the raw arguments in a fixed-size
+// preallocated slot; a single drainer thread pops the slots and does the
+// printf formatting. push() only walks the format string to learn the
+// argument types and copies %s strings, so it never blocks, allocates or
+// touches locale/float conversion code on SCHED_FIFO threads. When the
+// queue is full the record is dropped and counted.
+//
+// The format string must outlive the record (LOGD/LOGE pass literals).
+// %s arguments share kStringBytes and are cut to fit. A format push()
+// cannot capture (more than kMaxArgs arguments, or a conversion it does not
+// know) is formatted by the producer instead, cut to kStringBytes.
+class LogQueue {
+public:
+    static constexpr size_t kCapacity = 128;  // Power of two
+    static constexpr size_t kTextSize = 248;
+    static constexpr size_t kMaxArgs = 12;
+    static constexpr size_t kStringBytes = 160;  // Copies of %s arguments
+
+    struct Record {
+        int priority;
+        char text[kTextSize];
+        // Set for a pushCall() record, which has no text.
+        void (*call)(void*);
+        void* callArg;
+    };
+
+    LogQueue();
+    LogQueue(const LogQueue&) = delete;
+    LogQueue& operator=(const LogQueue&) = delete;
+
+    // Producers. Returns false if the record was dropped.
+    bool push(int priority, const char* fmt, va_list args);
+    // Queues call(arg) for the drainer, in order with the log records.
+    // Returns false, without counting a drop, when the queue is full.
+    bool pushCall(void (*call)(void*), void* arg);
+
+    // Drainer only: formats the oldest record into `out`, or hands back its
+    // call. Returns false when empty.
+    bool pop(Record* out);
+
+    // Drainer only: sleep until a record is pushed or the timeout expires.
+    void waitForRecords(std::chrono::milliseconds timeout);
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Arg {
+        enum Kind : uint8_t { kSigned, kUnsigned, kDouble, kPointer, kString };
+        Kind kind;
+        union {
+            long long i;
+            unsigned long long u;
+            double d;
+            const void* p;
+            size_t offset;  // Into Entry::strings
+        };
+    };
+
+    struct Entry {
+        int priority;
+        const char* fmt;  // nullptr: `strings` already holds the text
+        void (*call)(void*);  // Non-null: a pushCall() record
+        void* callArg;
+        uint8_t argCount;
+        Arg args[kMaxArgs];
+        char strings[kStringBytes];
+    };
+
+    struct Slot {
+        // == position: free for that push; == position + 1: holds a record.
+        std::atomic<size_t> sequence;
+        Entry entry;
+    };
+
+    // Reserves the next slot; nullptr when full.
+    Slot* claim(size_t* pos);
+    void publish(Slot* slot, size_t pos);
+
+    static void capture(Entry* entry, const char* fmt, va_list args);
+    static void format(const Entry& entry, char* out, size_t size);
+
+    Slot slots_[kCapacity];
+
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) size_t dequeue_pos_ = 0;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint32_t> signal_{0};
+    std::atomic<uint32_t> waiters_{0};
+};
+
+#endif  // LOG_QUEUE_H
@@ -6,211 +6,97 @@
 
 #include <cstdarg>
 #include <cstdio>
+#include <mutex>
+#include <thread>
 
-JavaVM* javaVM = nullptr;
-jobject serviceObj = nullptr;
+#include "log_queue.h"
 
-void logToJava(const char* fmt, ...) {
-    if (!javaVM || !serviceObj) return;
+namespace {
 
-    char buffer[512];
-    va_list args;
-    va_start(args, fmt);
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
-    va_end(args);
-
-    JNIEnv* env;
-    bool attached = false;
-    int getEnvStat = javaVM->GetEnv((void**)&env, JNI_VERSION_1_6);
-
-    if (getEnvStat == JNI_EDETACHED) {
-        if (javaVM->AttachCurrentThread(&env, nullptr) != 0) return;
-        attached = true;
-    } else if (getEnvStat != JNI_OK) {
-        return;
+class StderrLogSink : public LogSink {
+public:
+    void writeLog(int priority, const char* text) override {
+        fprintf(stderr, "%c %s\n", priority >= kLogError ? 'E' : 'D', text);
     }
+};
 
-    jclass cls = env->GetObjectClass(serviceObj);
-    jmethodID mid = env->GetMethodID(cls, "onNativeLog", "(Ljava/lang/String;)V");
-    if (mid) {
-        jstring jLog = env->NewStringUTF(buffer);
-        env->CallVoidMethod(serviceObj, mid, jLog);
-        env->DeleteLocalRef(jLog);
-    }
-    env->DeleteLocalRef(cls);
-
-    if (attached) {
-        javaVM->DetachCurrentThread();
-    }
-}
+StderrLogSink stderrSink;
+LogSink* sink = &stderrSink;
 
-void reportTidToJava(int tid) {
-    if (!javaVM || !serviceObj) return;
+LogQueue logQueue;
 
-    JNIEnv* env;
-    bool attached = false;
-    int getEnvStat = javaVM->GetEnv((void**)&env, JNI_VERSION_1_6);
+}  // namespace
 
-    if (getEnvStat == JNI_EDETACHED) {
-        if (javaVM->AttachCurrentThread(&env, nullptr) != 0) return;
-        attached = true;
-    } else if (getEnvStat != JNI_OK) {
-        return;
-    }
-
-    jclass cls = env->GetObjectClass(serviceObj);
-    jmethodID mid = env->GetMethodID(cls, "onNativeThreadStart", "(I)V");
-    if (mid) {
-        env->CallVoidMethod(serviceObj, mid, tid);
-    }
-    env->DeleteLocalRef(cls);
-
-    if (attached) {
-        javaVM->DetachCurrentThread();
-    }
+void setLogSink(LogSink* newSink) {
+    sink = newSink ? newSink : &stderrSink;
 }
 
-void reportErrorToJava(const char* fmt, ...) {
-    if (!javaVM || !serviceObj) return;
-
-    char buffer[512];
+void logAsync(int priority, const char* fmt, ...) {
     va_list args;
     va_start(args, fmt);
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    logQueue.push(priority, fmt, args);
     va_end(args);
-
-    JNIEnv* env;
-    bool attached = false;
-    int getEnvStat = javaVM->GetEnv((void**)&env, JNI_VERSION_1_6);
-
-    if (getEnvStat == JNI_EDETACHED) {
-        if (javaVM->AttachCurrentThread(&env, nullptr) != 0) return;
-        attached = true;
-    } else if (getEnvStat != JNI_OK) {
-        return;
-    }
-
-    jclass cls = env->GetObjectClass(serviceObj);
-    jmethodID mid = env->GetMethodID(cls, "onNativeError", "(Ljava/lang/String;)V");
-    if (mid) {
-        jstring jMsg = env->NewStringUTF(buffer);
-        env->CallVoidMethod(serviceObj, mid, jMsg);
-        env->DeleteLocalRef(jMsg);
-    }
-    env->DeleteLocalRef(cls);
-
-    if (attached) {
-        javaVM->DetachCurrentThread();
-    }
 }
 
-void reportOutputDisconnectToJava() {
-    if (!javaVM || !serviceObj) return;
-
-    JNIEnv* env;
-    bool attached = false;
-    int getEnvStat = javaVM->GetEnv((void**)&env, JNI_VERSION_1_6);
-
-    if (getEnvStat == JNI_EDETACHED) {
-        if (javaVM->AttachCurrentThread(&env, nullptr) != 0) return;
-        attached = true;
-    } else if (getEnvStat != JNI_OK) {
-        return;
-    }
+static void drainLogs() {
+    // Stay well below the audio threads.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+    sink->onDrainerStart();
+
+    uint64_t reportedDrops = 0;
+    LogQueue::Record record;
+    while (true) {
+        while (logQueue.pop(&record)) {
+            if (record.call) {
+                record.call(record.callArg);
+            } else {
+                sink->writeLog(record.priority, record.text);
+            }
+        }
 
-    jclass cls = env->GetObjectClass(serviceObj);
-    jmethodID mid = env->GetMethodID(cls, "onOutputDisconnect", "()V");
-    if (mid) {
-        env->CallVoidMethod(serviceObj, mid);
-    }
-    env->DeleteLocalRef(cls);
+        uint64_t dropped = logQueue.dropped();
+        if (dropped != reportedDrops) {
+            char text[96];
+            snprintf(text, sizeof(text), "[Native] Log queue full, %llu message(s) dropped",
+                     (unsigned long long)(dropped - reportedDrops));
+            sink->writeLog(kLogWarn, text);
+            reportedDrops = dropped;
+        }
 
-    if (attached) {
-        javaVM->DetachCurrentThread();
+        logQueue.waitForRecords(std::chrono::milliseconds(500));
     }
 }
 
-void reportStateToJava(int stateCode) {
-    if (!javaVM || !serviceObj) return;
-
-    JNIEnv* env;
-    bool attached = false;
-    int getEnvStat = javaVM->GetEnv((void**)&env, JNI_VERSION_1_6);
+void startLogDrainer() {
+    static std::once_flag started;
+    std::call_once(started, [] { std::thread(drainLogs).detach(); });
+}
 
-    if (getEnvStat == JNI_EDETACHED) {
-        if (javaVM->AttachCurrentThread(&env, nullptr) != 0) return;
-        attached = true;
-    } else if (getEnvStat != JNI_OK) {
-        return;
+void runOnLogDrainer(void (*call)(void*), void* arg) {
+    while (!logQueue.pushCall(call, arg)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
+}
 
-    jclass cls = env->GetObjectClass(serviceObj);
-    jmethodID mid = env->GetMethodID(cls, "onNativeState", "(I)V");
-    if (mid) {
-        env->CallVoidMethod(serviceObj, mid, stateCode);
-    }
-    env->DeleteLocalRef(cls);
+void reportTidToJava(int tid) { sink->onThreadStart(tid); }
 
-    if (attached) {
-        javaVM->DetachCurrentThread();
-    }
+void reportErrorToJava(const char* fmt, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    sink->onError(buffer);
 }
 
-void reportStatsToJava(int rate, int period, int bufferSize) {
-    if (!javaVM || !serviceObj) {
-        // Cannot log here easily as we are in logging implementation, avoid
-        // recursion loops if we use LOGE
-        __android_log_print(ANDROID_LOG_ERROR, TAG,
-                            "[Native] Stats report failed: VM or ServiceObj null");
-        return;
-    }
+void reportOutputDisconnectToJava() { sink->onOutputDisconnect(); }
 
-    JNIEnv* env;
-    bool attached = false;
-    int getEnvStat = javaVM->GetEnv((void**)&env, JNI_VERSION_1_6);
+void reportStateToJava(int stateCode) { sink->onState(stateCode); }
 
-    if (getEnvStat == JNI_EDETACHED) {
-        if (javaVM->AttachCurrentThread(&env, nullptr) != 0) {
-            __android_log_print(ANDROID_LOG_ERROR, TAG,
-                                "[Native] Stats report failed: Could not attach thread");
-            return;
-        }
-        attached = true;
-    } else if (getEnvStat != JNI_OK) {
-        __android_log_print(ANDROID_LOG_ERROR, TAG, "[Native] Stats report failed: GetEnv error %d",
-                            getEnvStat);
-        return;
-    }
+void reportHostRateToJava(int rate) { sink->onHostRateChange(rate); }
 
-    jclass cls = env->GetObjectClass(serviceObj);
-    jmethodID mid = env->GetMethodID(cls, "onNativeStats", "(III)V");
-    if (mid) {
-        env->CallVoidMethod(serviceObj, mid, rate, period, bufferSize);
-        if (env->ExceptionCheck()) {
-            __android_log_print(ANDROID_LOG_ERROR, TAG,
-                                "[Native] Exception handling onNativeStats!");
-            env->ExceptionDescribe();
-            env->ExceptionClear();
-        }
-    } else {
-        __android_log_print(ANDROID_LOG_ERROR, TAG,
-                            "[Native] Stats report failed: Method ID not found");
-    }
-    env->DeleteLocalRef(cls);
-
-    if (attached) {
-        javaVM->DetachCurrentThread();
-    }
+void reportCaptureLayoutToJava(int periodFrames, int periodCount) {
+    sink->onCaptureLayout(periodFrames, periodCount);
 }
 
-void setHighPriority() {
-    pid_t tid = syscall(SYS_gettid);
-
-    // 1. Set Nice value
-    int priority = -19;
-    setpriority(PRIO_PROCESS, tid, priority);
-    LOGD("[Native] Thread %d nicely set to %d", tid, priority);
-
-    // 2. Request Root Escalation to SCHED_FIFO
-    reportTidToJava((int)tid);
-}
+void reportLatencyTargetToJava(int targetFrames) { sink->onLatencyTarget(targetFrames); }
@@ -1,34 +1,64 @@
 #ifndef LOGGING_H
 #define LOGGING_H
 
-#include <android/log.h>
-#include <jni.h>
+// Priorities match android_LogPriority so the app's sink passes them through.
+enum LogPriority {
+    kLogDebug = 3,
+    kLogWarn = 5,
+    kLogError = 6,
+};
 
-#define TAG "UsbAudioNative"
+// --- Log Sink ---
+// Where log lines and status reports leave the bridge core. The app installs
+// the JNI sink (Logcat plus AudioService callbacks); without one, lines go to
+// stderr and reports are dropped, which is what host builds want.
+class LogSink {
+public:
+    virtual ~LogSink() = default;
 
-// JNI Globals
-extern JavaVM* javaVM;
-extern jobject serviceObj;
+    // Drainer thread only: called once before the first line, then per line.
+    virtual void onDrainerStart() {}
+    virtual void writeLog(int priority, const char* text) = 0;
 
-// Helper to send logs back to Java
-void logToJava(const char* fmt, ...);
+    // Status reports, called on the reporting (often audio) thread.
+    virtual void onThreadStart(int tid) {}
+    virtual void onError(const char* message) {}
+    virtual void onOutputDisconnect() {}
+    virtual void onState(int stateCode) {}
+    virtual void onHostRateChange(int rate) {}
+    virtual void onCaptureLayout(int periodFrames, int periodCount) {}
+    virtual void onLatencyTarget(int targetFrames) {}
+};
 
-// Redirect logs to both Logcat and Java Callback
-#define LOGD(...)                                             \
-    __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__); \
-    logToJava(__VA_ARGS__)
-#define LOGE(...)                                             \
-    __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__); \
-    logToJava(__VA_ARGS__)
+// Install before startLogDrainer(); the sink must outlive the process.
+void setLogSink(LogSink* sink);
 
-// Helper functions for Java callbacks
+// Queue a log line for the sink. Never blocks, so it is safe on the
+// real-time capture and consume threads; a low-priority drainer thread
+// does the actual printing.
+void logAsync(int priority, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// Start the drainer (idempotent). Lines queued before this are kept.
+void startLogDrainer();
+
+// Run call(arg) on the drainer once every line queued before it has gone
+// to the sink, e.g. to free something writeLog() may still be using. Waits
+// for room when the queue is full, so not for the real-time threads.
+void runOnLogDrainer(void (*call)(void*), void* arg);
+
+#define LOGD(...) logAsync(kLogDebug, __VA_ARGS__)
+#define LOGE(...) logAsync(kLogError, __VA_ARGS__)
+
+// Status reports, forwarded to the sink (AudioService in the app)
 void reportTidToJava(int tid);
-void reportErrorToJava(const char* fmt, ...);
+void reportErrorToJava(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
 void reportOutputDisconnectToJava();
 void reportStateToJava(int stateCode);
-void reportStatsToJava(int rate, int period, int bufferSize);
-
-// Thread priority helper (uses reportTidToJava)
-void setHighPriority();
+// The host now streams at `rate`, which differs from the bridge's.
+void reportHostRateToJava(int rate);
+// A capture layout worked that differs from the start hint; Java persists it.
+void reportCaptureLayoutToJava(int periodFrames, int periodCount);
+// Adaptive latency moved its target fill; Java persists it for the route.
+void reportLatencyTargetToJava(int targetFrames);
 
 #endif  // LOGGING_H
@@ -3,11 +3,25 @@
 #include <chrono>
 #include <thread>
 
+#include "audio/android_audio_backend.h"
 #include "core/bridge.h"
+#include "core/bridge_stats.h"
+#include "core/stop_signal.h"
+#include "logging/jni_callbacks.h"
+#include "logging/jni_log_sink.h"
 #include "logging/logging.h"
 
 extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved) {
   javaVM = vm;
+  JNIEnv *env = nullptr;
+  if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) == JNI_OK) {
+    registerJniCallbacks(env);
+  }
+  static JniLogSink logSink;
+  static AndroidAudioBackend audioBackend;
+  setLogSink(&logSink);
+  setAudioBackend(&audioBackend);
+  startLogDrainer();
   return JNI_VERSION_1_6;
 }
 
@@ -16,21 +30,17 @@ Java_com_flopster101_usbaudiobridge_AudioService_startAudioBridge(
     JNIEnv *env, jobject thiz, jint card, jint device, jint bufferSizeFrames,
     jint periodSizeFrames, jint engineType, jint sampleRate,
     jint activeDirections, jint micSource) {
-  // Wait for previous instance to clean up
-  int safety = 0;
-  // Increase timeout to 3s (300 * 10ms) to allow for 1s sleep in captureLoop +
-  // cleanup
-  while (!isFinished && safety++ < 300) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-  }
+  // Wait for previous instance to clean up. Stop wakes every blocking point,
+  // so this normally returns within milliseconds; the cap only covers a
+  // driver call that will not let go.
+  waitForBridgeFinished(std::chrono::seconds(3));
 
   if (isRunning)
     return false; // Return false if already running
+  bridgeStop.clear();
 
   // Capture the Service object globally so threads can call back to it
-  if (serviceObj)
-    env->DeleteGlobalRef(serviceObj);
-  serviceObj = env->NewGlobalRef(thiz);
+  setServiceObject(env, thiz);
 
   isRunning = true;
   isFinished = false;
@@ -47,6 +57,7 @@ Java_com_flopster101_usbaudiobridge_AudioService_stopAudioBridge(
   if (!isRunning)
     return;
   isRunning = false;
+  bridgeStop.raise();
   LOGD("[Native] Stop command received.");
 }
 
@@ -61,3 +72,48 @@ Java_com_flopster101_usbaudiobridge_AudioService_setNativeMicMute(
     JNIEnv *env, jobject /* this */, jboolean muted) {
     isMicMuted = muted;
 }
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_flopster101_usbaudiobridge_AudioService_setNativeRateAdaptation(
+    JNIEnv *env, jobject /* this */, jboolean enabled) {
+    isRateAdaptationEnabled = enabled;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_flopster101_usbaudiobridge_AudioService_setNativeCpuPinning(
+    JNIEnv *env, jobject /* this */, jboolean enabled) {
+    isCpuPinningEnabled = enabled;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_flopster101_usbaudiobridge_AudioService_setNativeSingleThread(
+    JNIEnv *env, jobject /* this */, jboolean enabled) {
+    isSingleThreadEnabled = enabled;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_flopster101_usbaudiobridge_AudioService_setNativeCaptureLayoutHint(
+    JNIEnv *env, jobject /* this */, jint periodFrames, jint periodCount) {
+    captureHintPeriodFrames = periodFrames;
+    captureHintPeriodCount = periodCount;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_flopster101_usbaudiobridge_AudioService_setNativeAdaptiveLatency(
+    JNIEnv *env, jobject /* this */, jboolean enabled) {
+    isAdaptiveLatencyEnabled = enabled;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_flopster101_usbaudiobridge_AudioService_setNativeLatencyTargetHint(
+    JNIEnv *env, jobject /* this */, jint targetFrames) {
+    latencyTargetHintFrames = targetFrames;
+}
+
+// Handed out once; the block lives for the whole process so the buffer never
+// dangles.
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_flopster101_usbaudiobridge_AudioService_getNativeStatsBuffer(
+    JNIEnv *env, jobject /* this */) {
+    return env->NewDirectByteBuffer(&bridgeStats, sizeof(bridgeStats));
+}
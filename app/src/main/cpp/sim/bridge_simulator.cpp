@@ -0,0 +1,346 @@
+#include "bridge_simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "../audio/audio_frame.h"
+#include "../audio/ring_buffer.h"
+
+namespace {
+
+using SimRing = RingBuffer<FrameS16Stereo>;
+
+constexpr int64_t kNever = INT64_MAX;
+
+std::chrono::steady_clock::time_point timeAt(int64_t nanos) {
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(nanos));
+}
+
+// Uniform lateness in [0, ms].
+int64_t lateness(std::mt19937& rng, double ms) {
+    if (ms <= 0.0) return 0;
+    return static_cast<int64_t>(std::uniform_real_distribution<double>(0.0, ms * 1e6)(rng));
+}
+
+// Windows during which one thread cannot run: exponential gaps with the
+// given mean, fixed length. Queried with non-decreasing times.
+class StallSchedule {
+public:
+    StallSchedule(double intervalSec, double stallMs, uint32_t seed)
+        : rng_(seed), meanGapNs_(intervalSec * 1e9), lengthNs_(stallMs * 1e6) {
+        if (enabled()) scheduleFrom(0);
+    }
+
+    // Earliest time at or after `t` at which the thread runs.
+    int64_t delay(int64_t t) {
+        if (!enabled()) return t;
+        while (end_ <= t) scheduleFrom(end_);
+        return t >= start_ ? end_ : t;
+    }
+
+private:
+    bool enabled() const { return meanGapNs_ > 0.0 && lengthNs_ > 0.0; }
+
+    void scheduleFrom(int64_t t) {
+        double gap = std::exponential_distribution<double>(1.0 / meanGapNs_)(rng_);
+        start_ = t + static_cast<int64_t>(gap);
+        end_ = start_ + static_cast<int64_t>(lengthNs_);
+    }
+
+    std::mt19937 rng_;
+    double meanGapNs_;
+    double lengthNs_;
+    int64_t start_ = kNever;
+    int64_t end_ = kNever;
+};
+
+double percentileOf(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+}  // namespace
+
+SimResult simulateBridge(const SimScenario& sc, const SimStrategy& st) {
+    SimResult result;
+    const int rate = sc.rate > 0 ? sc.rate : 48000;
+    const int64_t periodFrames = std::max(1, sc.periodFrames);
+    const int64_t pcmBufferFrames = periodFrames * std::max(2, sc.periodCount);
+    const int64_t burstFrames = std::max(1, sc.deviceBurstFrames);
+    const int64_t deviceBufferFrames = std::max<int64_t>(burstFrames, sc.deviceBufferFrames);
+
+    // --- Policy: the bridge's own numbers, then the strategy's overrides ---
+    BufferPlan plan = st.guardFrames >= 0
+                          ? BufferPlan::withGuard(sc.bufferSizeFrames, rate, st.guardFrames)
+                          : BufferPlan::forRequest(sc.bufferSizeFrames, rate);
+    if (st.prerollFrames > 0) {
+        plan.prerollFrames = std::min<size_t>(st.prerollFrames, plan.ringFrames());
+    }
+    ChunkStrategy chunking = ChunkStrategy::forEngine(sc.engineType, sc.deviceBurstFrames,
+                                                      sc.periodFrames, plan.ringFrames());
+    if (st.normalFrames > 0) chunking.normalFrames = st.normalFrames;
+    if (st.reducedFrames > 0) chunking.reducedFrames = st.reducedFrames;
+    if (st.lowWaterFrames >= 0) chunking.lowWaterFrames = st.lowWaterFrames;
+    if (st.highWaterFrames >= 0) chunking.highWaterFrames = st.highWaterFrames;
+    if (st.dwellMs >= 0) chunking.minModeDwell = std::chrono::milliseconds(st.dwellMs);
+    result.plan = plan;
+    result.chunking = chunking;
+
+    SimRing ring(plan.ringFrames());
+    ChunkSelector selector(chunking, timeAt(0));
+
+    std::mt19937 hostRng(sc.seed);
+    std::mt19937 captureRng(sc.seed + 1);
+    std::mt19937 bridgeRng(sc.seed + 2);
+    std::mt19937 deviceRng(sc.seed + 3);
+    StallSchedule captureStalls(sc.captureStallIntervalSec, sc.captureStallMs, sc.seed + 4);
+    StallSchedule outputStalls(sc.outputStallIntervalSec, sc.outputStallMs, sc.seed + 5);
+
+    int64_t endNs = static_cast<int64_t>(sc.seconds * 1e9);
+    const bool captureReplay = !sc.captureTrace.empty();
+    const bool deviceReplay = !sc.deviceTrace.empty();
+
+    // Host and gadget PCM. A replayed capture trace commits to the ring
+    // directly and bypasses both.
+    const double packetPeriodNs = 1e6 / (1.0 + sc.hostDriftPpm * 1e-6);
+    int64_t packetIndex = 0;
+    int64_t nextPacketNs = captureReplay ? kNever : lateness(hostRng, sc.hostJitterMs);
+    size_t captureTraceIndex = 0;
+    int64_t nextCaptureTraceNs = captureReplay ? sc.captureTrace[0].timeNs : kNever;
+    int64_t pcmFrames = 0;
+    int64_t captureWakeNs = kNever;
+
+    // Bridge thread.
+    enum class Bridge { Preroll, Running, WaitingData, Blocked };
+    Bridge bridge = Bridge::Preroll;
+    int64_t bridgeReadyNs = kNever;
+    bool ringDry = false;
+    int64_t inFlightFrames = 0;  // Read from the ring, not yet released
+    int64_t pendingFrames = 0;   // Part of the write the device has not taken
+    int64_t streamStartNs = kNever;
+    int64_t lastSelectorNs = 0;
+    int64_t reducedNs = 0;
+
+    // Output device.
+    const double burstPeriodNs = burstFrames * 1e9 / rate / (1.0 + sc.deviceDriftPpm * 1e-6);
+    int64_t deviceQueue = 0;
+    int64_t deviceStartNs = kNever;
+    int64_t burstIndex = 1;  // The first burst is due a period after the first write
+    size_t deviceTraceIndex = 0;
+    int64_t nextBurstNs = kNever;
+
+    std::vector<double> latencyMs;
+    latencyMs.reserve(static_cast<size_t>(sc.seconds * rate / burstFrames) + 1);
+
+    auto wakeBridge = [&](int64_t t) {
+        if (bridgeReadyNs == kNever) {
+            bridgeReadyNs = outputStalls.delay(t + lateness(bridgeRng, sc.wakeJitterMs));
+        }
+    };
+
+    auto commitCapture = [&](int64_t t, int64_t frames) {
+        SimRing::Regions span = ring.beginWrite(static_cast<size_t>(frames));
+        int64_t written = static_cast<int64_t>(span.frames());
+        if (written > 0) ring.commitWrite(span.frames());
+        result.capturedFrames += written;
+        if (written < frames) {
+            result.overruns++;
+            result.overrunFrames += frames - written;
+        }
+        if (bridge == Bridge::WaitingData ||
+            (bridge == Bridge::Preroll && ring.available() >= plan.prerollFrames)) {
+            wakeBridge(t);
+        }
+    };
+
+    // Hands as much of the pending write to the device as its queue takes.
+    auto acceptPending = [&]() {
+        int64_t accepted = std::min(pendingFrames, deviceBufferFrames - deviceQueue);
+        deviceQueue += accepted;
+        pendingFrames -= accepted;
+    };
+
+    auto scheduleBurst = [&](int64_t t) {
+        if (deviceReplay) {
+            nextBurstNs = deviceTraceIndex < sc.deviceTrace.size()
+                              ? deviceStartNs + sc.deviceTrace[deviceTraceIndex].timeNs
+                              : kNever;
+            if (nextBurstNs == kNever) endNs = std::min(endNs, t);
+        } else {
+            int64_t nominal = deviceStartNs + std::llround(burstIndex * burstPeriodNs);
+            nextBurstNs = std::max(t, nominal + lateness(deviceRng, sc.deviceJitterMs));
+        }
+    };
+
+    int64_t t = 0;
+    while (true) {
+        t = std::min({nextPacketNs, nextCaptureTraceNs, captureWakeNs, nextBurstNs,
+                      bridgeReadyNs});
+        if (t == kNever || t >= endNs) break;
+
+        if (t == nextPacketNs) {
+            // --- Host packet into the gadget PCM ---
+            pcmFrames += ((packetIndex + 1) * rate) / 1000 - (packetIndex * rate) / 1000;
+            if (pcmFrames >= pcmBufferFrames) {
+                // The PCM stops at the threshold; the restart loses it all.
+                result.captureXruns++;
+                result.xrunFrames += pcmFrames;
+                pcmFrames = 0;
+            }
+            packetIndex++;
+            int64_t nominal = std::llround(packetIndex * packetPeriodNs);
+            nextPacketNs = std::max(t, nominal + lateness(hostRng, sc.hostJitterMs));
+            if (captureWakeNs == kNever && pcmFrames >= periodFrames) {
+                captureWakeNs = captureStalls.delay(t + lateness(captureRng, sc.wakeJitterMs));
+            }
+        } else if (t == nextCaptureTraceNs) {
+            commitCapture(t, sc.captureTrace[captureTraceIndex].frames);
+            captureTraceIndex++;
+            nextCaptureTraceNs = captureTraceIndex < sc.captureTrace.size()
+                                     ? sc.captureTrace[captureTraceIndex].timeNs
+                                     : kNever;
+            if (nextCaptureTraceNs == kNever) endNs = std::min(endNs, t + 1);
+        } else if (t == captureWakeNs) {
+            // --- Capture thread: whole periods into the ring ---
+            captureWakeNs = kNever;
+            while (pcmFrames >= periodFrames) {
+                pcmFrames -= periodFrames;
+                commitCapture(t, periodFrames);
+            }
+        } else if (t == nextBurstNs) {
+            // --- Device burst ---
+            int64_t want = deviceReplay ? sc.deviceTrace[deviceTraceIndex].frames : burstFrames;
+            int64_t take = std::min(want, deviceQueue);
+            deviceQueue -= take;
+            result.playedFrames += take;
+            if (take < want) {
+                result.deviceUnderruns++;
+                result.silenceFrames += want - take;
+            }
+            int64_t buffered = pcmFrames + static_cast<int64_t>(ring.available()) -
+                               inFlightFrames + pendingFrames + deviceQueue;
+            latencyMs.push_back(buffered * 1000.0 / rate);
+
+            if (bridge == Bridge::Blocked) {
+                acceptPending();
+                if (pendingFrames == 0) {
+                    // write() returns and only then hands the space back.
+                    ring.commitRead(static_cast<size_t>(inFlightFrames));
+                    inFlightFrames = 0;
+                    bridge = Bridge::Running;
+                    wakeBridge(t);
+                }
+            }
+            if (deviceReplay) {
+                deviceTraceIndex++;
+            } else {
+                burstIndex++;
+            }
+            scheduleBurst(t);
+        } else {
+            // --- Bridge push loop iteration ---
+            bridgeReadyNs = kNever;
+            if (bridge == Bridge::Preroll) {
+                selector = ChunkSelector(chunking, timeAt(t));
+                streamStartNs = t;
+                lastSelectorNs = t;
+            }
+            bridge = Bridge::Running;
+
+            if (selector.reduced()) reducedNs += t - lastSelectorNs;
+            lastSelectorNs = t;
+            selector.update(ring.available(), timeAt(t));
+
+            SimRing::Regions span = ring.beginRead(selector.chunkFrames());
+            int64_t readFrames = static_cast<int64_t>(span.frames());
+            if (readFrames == 0) {
+                if (!ringDry) {
+                    ringDry = true;
+                    result.ringUnderruns++;
+                }
+                bridge = Bridge::WaitingData;
+                continue;
+            }
+            ringDry = false;
+
+            pendingFrames = readFrames;
+            acceptPending();
+            if (deviceStartNs == kNever) {
+                // A push engine only starts pulling once it has data.
+                deviceStartNs = t;
+                scheduleBurst(t);
+            }
+            if (pendingFrames == 0) {
+                // Fit in the device queue: write() returns and the loop
+                // goes round again without sleeping.
+                ring.commitRead(span.frames());
+                bridgeReadyNs = outputStalls.delay(t);
+            } else {
+                inFlightFrames = readFrames;
+                bridge = Bridge::Blocked;
+            }
+        }
+    }
+
+    int64_t finishedNs = std::min(t, endNs);
+    if (streamStartNs != kNever) {
+        if (selector.reduced()) reducedNs += std::max<int64_t>(0, finishedNs - lastSelectorNs);
+        int64_t streamNs = finishedNs - streamStartNs;
+        if (streamNs > 0) result.reducedPercent = 100.0 * reducedNs / streamNs;
+    }
+    result.seconds = finishedNs / 1e9;
+    result.modeSwitches = selector.switchCount();
+
+    if (!latencyMs.empty()) {
+        std::sort(latencyMs.begin(), latencyMs.end());
+        double sum = 0.0;
+        for (double ms : latencyMs) sum += ms;
+        result.latencyMinMs = latencyMs.front();
+        result.latencyMeanMs = sum / latencyMs.size();
+        result.latencyP50Ms = percentileOf(latencyMs, 50);
+        result.latencyP95Ms = percentileOf(latencyMs, 95);
+        result.latencyP99Ms = percentileOf(latencyMs, 99);
+        result.latencyMaxMs = latencyMs.back();
+    }
+    return result;
+}
+
+bool loadTimingTrace(const char* path, std::vector<SimTimingEvent>* events) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    events->clear();
+    char line[256];
+    bool ok = true;
+    while (fgets(line, sizeof(line), file)) {
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        long long timeNs = 0;
+        long long frames = 0;
+        char extra = 0;
+        int fields = sscanf(line, "%lld %lld %c", &timeNs, &frames, &extra);
+        if (fields == EOF) continue;  // Blank or comment only
+        if (fields != 2 || frames < 0) {
+            ok = false;
+            break;
+        }
+        events->push_back({timeNs, frames});
+    }
+    fclose(file);
+    if (!ok) return false;
+
+    std::stable_sort(events->begin(), events->end(),
+                     [](const SimTimingEvent& a, const SimTimingEvent& b) {
+                         return a.timeNs < b.timeNs;
+                     });
+    if (!events->empty()) {
+        int64_t origin = events->front().timeNs;
+        for (SimTimingEvent& event : *events) event.timeNs -= origin;
+    }
+    return true;
+}
@@ -0,0 +1,120 @@
+#ifndef BRIDGE_SIMULATOR_H
+#define BRIDGE_SIMULATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../core/buffer_plan.h"
+#include "../core/chunk_strategy.h"
+
+// --- Offline Bridge Timing Simulator ---
+// Discrete-event model of the speaker path in virtual time, for trying
+// buffer and watermark policies without a phone or real-time waits. The
+// ring is a real RingBuffer sized by BufferPlan and the push loop's chunk
+// decisions come from the real ChunkSelector; only the timing around them
+// is modelled:
+//
+//   host       1 ms packets into the gadget PCM buffer (period x count),
+//              with ppm drift and per-packet jitter. A full PCM buffer is a
+//              capture xrun and its contents are lost.
+//   capture    Wakes some latency after a period is available, stalls
+//              occasionally, and commits whole periods to the ring. What
+//              does not fit is a ring overrun.
+//   bridge     The push loop: update the selector with the fill, take up to
+//              a chunk, block in write() while the device queue is full,
+//              sleep on the ring while it is empty.
+//   device     Drains bursts from its queue at its own clock; a short queue
+//              is an audible underrun.
+//
+// Either side can instead be replayed from a recorded trace. Rate
+// adaptation is not modelled: the simulator evaluates the chunk toggling
+// it replaces.
+
+// One recorded timing point: capture commits (periods reaching the ring) or
+// device reads, `frames` at `timeNs`.
+struct SimTimingEvent {
+    int64_t timeNs;
+    int64_t frames;
+};
+
+struct SimScenario {
+    int rate = 48000;
+    int engineType = 0;          // As passed to bridgeTask
+    int bufferSizeFrames = 1920;  // The user's buffer setting
+    int periodFrames = 240;      // Capture PCM layout
+    int periodCount = 4;
+    double seconds = 60.0;
+    uint32_t seed = 1;
+
+    double hostDriftPpm = 0.0;  // Positive delivers faster
+    double hostJitterMs = 0.0;  // Uniform lateness per packet
+    // Thread wakeup latency, uniform in [0, wakeJitterMs], for capture and
+    // bridge alike.
+    double wakeJitterMs = 0.05;
+    // Scheduler stalls: mean interval (exponential) and length.
+    double captureStallIntervalSec = 0.0;
+    double captureStallMs = 0.0;
+    double outputStallIntervalSec = 0.0;
+    double outputStallMs = 0.0;
+
+    int deviceBurstFrames = 192;   // Also the engine's reported burst
+    int deviceBufferFrames = 960;  // Queue behind write()
+    double deviceDriftPpm = 0.0;   // Positive drains faster
+    double deviceJitterMs = 0.0;   // Uniform lateness per burst
+
+    // Recorded timing; a non-empty trace replaces that side's model.
+    std::vector<SimTimingEvent> captureTrace;
+    std::vector<SimTimingEvent> deviceTrace;
+};
+
+// A buffer policy to evaluate. Negative fields keep what the bridge itself
+// would use for the scenario.
+struct SimStrategy {
+    std::string name = "default";
+    int64_t guardFrames = -1;
+    int64_t prerollFrames = -1;
+    int64_t normalFrames = -1;
+    int64_t reducedFrames = -1;
+    int64_t lowWaterFrames = -1;
+    int64_t highWaterFrames = -1;
+    int64_t dwellMs = -1;
+};
+
+struct SimResult {
+    BufferPlan plan;
+    ChunkStrategy chunking;
+    double seconds = 0.0;  // Simulated, from the first capture commit
+
+    int64_t capturedFrames = 0;  // Committed to the ring
+    int64_t playedFrames = 0;
+    // The bridge's own count: the ring found empty while streaming.
+    int ringUnderruns = 0;
+    // Bursts the device could not fill, and the silence that caused.
+    int deviceUnderruns = 0;
+    int64_t silenceFrames = 0;
+    int overruns = 0;
+    int64_t overrunFrames = 0;
+    int captureXruns = 0;
+    int64_t xrunFrames = 0;
+    int modeSwitches = 0;
+    double reducedPercent = 0.0;  // Of streaming time spent on the reduced chunk
+
+    // Host-to-speaker latency at each device burst: PCM buffer, ring,
+    // pending write and device queue.
+    double latencyMinMs = 0.0;
+    double latencyMeanMs = 0.0;
+    double latencyP50Ms = 0.0;
+    double latencyP95Ms = 0.0;
+    double latencyP99Ms = 0.0;
+    double latencyMaxMs = 0.0;
+};
+
+SimResult simulateBridge(const SimScenario& scenario, const SimStrategy& strategy);
+
+// Reads "<time_ns> <frames>" lines; '#' starts a comment. Times are made
+// relative to the first event. False if the file cannot be read or a line
+// does not parse.
+bool loadTimingTrace(const char* path, std::vector<SimTimingEvent>* events);
+
+#endif  // BRIDGE_SIMULATOR_H
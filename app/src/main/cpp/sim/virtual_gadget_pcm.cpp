@@ -0,0 +1,722 @@
+#include "virtual_gadget_pcm.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sound/asound.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <tinyalsa/pcm.h>
+#include <tinyalsa/plugin.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace {
+
+// pcm_plugin.c owns the plugin state; the only transition made here is the
+// implicit start of a read on a prepared stream, as the kernel does.
+constexpr unsigned int kPlugStateRunning = 3;
+// SND_NODE_TYPE_PLUGIN from tinyalsa's private snd_card_plugin.h.
+constexpr int kNodeTypePlugin = 1;
+
+constexpr const char* kLibraryName = "libsndcardparser.so";
+constexpr double kToneHz = 1000.0;
+constexpr double kToneAmplitude = 0.25;  // -12 dBFS
+
+constexpr snd_pcm_format_t kFormats[] = {SNDRV_PCM_FORMAT_S16_LE, SNDRV_PCM_FORMAT_S24_3LE,
+                                         SNDRV_PCM_FORMAT_S32_LE, SNDRV_PCM_FORMAT_FLOAT_LE};
+
+int64_t monotonicNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+struct timespec toTimespec(int64_t nanos) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(nanos / 1000000000LL);
+    ts.tv_nsec = static_cast<long>(nanos % 1000000000LL);
+    return ts;
+}
+
+// pcm.c reads the reason from errno and only checks the sign of the result.
+int fail(int err) {
+    errno = err;
+    return -err;
+}
+
+struct Counters {
+    std::atomic<int64_t> framesDelivered{0};
+    std::atomic<int64_t> framesLost{0};
+    std::atomic<int> stalls{0};
+    std::atomic<int> xruns{0};
+    std::atomic<int> starts{0};
+    std::atomic<bool> disconnected{false};
+
+    void reset() {
+        framesDelivered = 0;
+        framesLost = 0;
+        stalls = 0;
+        xruns = 0;
+        starts = 0;
+        disconnected = false;
+    }
+};
+
+Counters gCounters;
+std::mutex gConfigMutex;
+VirtualGadgetConfig gConfig;
+bool gConfigured = false;
+
+double envDouble(const char* name, double fallback) {
+    const char* value = getenv(name);
+    return (value && *value) ? strtod(value, nullptr) : fallback;
+}
+
+VirtualGadgetConfig configFromEnv() {
+    VirtualGadgetConfig config;
+    config.rate = static_cast<unsigned int>(envDouble("USBAUDIO_VGADGET_RATE", config.rate));
+    config.driftPpm = envDouble("USBAUDIO_VGADGET_DRIFT_PPM", config.driftPpm);
+    config.jitterMs = envDouble("USBAUDIO_VGADGET_JITTER_MS", config.jitterMs);
+    config.stallIntervalSec = envDouble("USBAUDIO_VGADGET_STALL_INTERVAL_S", 0.0);
+    config.stallMs = envDouble("USBAUDIO_VGADGET_STALL_MS", config.stallMs);
+    config.disconnectAfterSec = envDouble("USBAUDIO_VGADGET_DISCONNECT_S", 0.0);
+    config.seed = static_cast<uint32_t>(envDouble("USBAUDIO_VGADGET_SEED", config.seed));
+    return config;
+}
+
+VirtualGadgetConfig currentConfig() {
+    std::lock_guard<std::mutex> lock(gConfigMutex);
+    if (!gConfigured) {
+        gConfig = configFromEnv();
+        gConfigured = true;
+    }
+    return gConfig;
+}
+
+size_t sampleBytes(snd_pcm_format_t format) {
+    switch (format) {
+        case SNDRV_PCM_FORMAT_S16_LE:
+            return 2;
+        case SNDRV_PCM_FORMAT_S24_3LE:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+// `value` in [-1, 1], little-endian like every format offered.
+void writeSample(uint8_t* dst, snd_pcm_format_t format, double value) {
+    switch (format) {
+        case SNDRV_PCM_FORMAT_S16_LE: {
+            int16_t s = static_cast<int16_t>(lrint(value * 32767.0));
+            memcpy(dst, &s, sizeof(s));
+            break;
+        }
+        case SNDRV_PCM_FORMAT_S24_3LE: {
+            int32_t s = static_cast<int32_t>(lrint(value * 8388607.0));
+            dst[0] = static_cast<uint8_t>(s);
+            dst[1] = static_cast<uint8_t>(s >> 8);
+            dst[2] = static_cast<uint8_t>(s >> 16);
+            break;
+        }
+        case SNDRV_PCM_FORMAT_S32_LE: {
+            int32_t s = static_cast<int32_t>(lrint(value * 2147483647.0));
+            memcpy(dst, &s, sizeof(s));
+            break;
+        }
+        default: {
+            float s = static_cast<float>(value);
+            memcpy(dst, &s, sizeof(s));
+            break;
+        }
+    }
+}
+
+// --- Virtual Gadget Stream ---
+// One opened PCM. hw_ and appl_ are absolute frame positions; the values
+// handed to tinyalsa wrap at boundary_ like the kernel's.
+class VirtualGadgetStream {
+public:
+    VirtualGadgetStream(const VirtualGadgetConfig& config, unsigned int flags)
+        : config_(config),
+          rng_(config.seed),
+          mmap_((flags & PCM_MMAP) != 0),
+          nonblock_((flags & PCM_NONBLOCK) != 0) {
+        pollFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+        constraints_.access = (1ULL << SNDRV_PCM_ACCESS_MMAP_INTERLEAVED) |
+                              (1ULL << SNDRV_PCM_ACCESS_RW_INTERLEAVED);
+        for (snd_pcm_format_t format : kFormats)
+            constraints_.format |= 1ULL << static_cast<unsigned int>(format);
+        constraints_.bit_width = {16, 32};
+        constraints_.channels = {2, 2};
+        constraints_.rate = {config.rate, config.rate};
+        constraints_.periods = {2, 32};
+        constraints_.period_bytes = {16 * 4, 8192 * 8};
+
+        plugin_.card = kVirtualGadgetCard;
+        plugin_.device = kVirtualGadgetDevice;
+        plugin_.constraints = &constraints_;
+        plugin_.mode = static_cast<int>(flags);
+        plugin_.priv = this;
+        plugin_.poll_fd = pollFd_;
+    }
+
+    ~VirtualGadgetStream() {
+        if (pollFd_ >= 0) close(pollFd_);
+    }
+
+    VirtualGadgetStream(const VirtualGadgetStream&) = delete;
+    VirtualGadgetStream& operator=(const VirtualGadgetStream&) = delete;
+
+    bool valid() const { return pollFd_ >= 0; }
+    struct pcm_plugin* plugin() { return &plugin_; }
+
+    int hwParams(struct snd_pcm_hw_params* params) {
+        const struct snd_mask& formats =
+            params->masks[SNDRV_PCM_HW_PARAM_FORMAT - SNDRV_PCM_HW_PARAM_FIRST_MASK];
+        bool found = false;
+        for (snd_pcm_format_t format : kFormats) {
+            unsigned int bit = static_cast<unsigned int>(format);
+            if (formats.bits[bit / 32] & (1U << (bit % 32))) {
+                format_ = format;
+                found = true;
+                break;
+            }
+        }
+        if (!found) return fail(EINVAL);
+
+        channels_ = interval(params, SNDRV_PCM_HW_PARAM_CHANNELS);
+        periodFrames_ = interval(params, SNDRV_PCM_HW_PARAM_PERIOD_SIZE);
+        unsigned int periods = interval(params, SNDRV_PCM_HW_PARAM_PERIODS);
+        if (interval(params, SNDRV_PCM_HW_PARAM_RATE) != config_.rate || channels_ == 0 ||
+            periodFrames_ == 0 || periods == 0) {
+            return fail(EINVAL);
+        }
+
+        frameBytes_ = channels_ * sampleBytes(format_);
+        bufferFrames_ = periodFrames_ * periods;
+        buffer_.assign(bufferFrames_ * frameBytes_, 0);
+        availMin_ = periodFrames_;
+        stopThreshold_ = bufferFrames_;
+        boundary_ = bufferFrames_;
+        while (boundary_ * 2 <= LONG_MAX - bufferFrames_) boundary_ *= 2;
+
+        packetFrames_ = std::max(1u, config_.rate / 1000);
+        packetNanos_ = packetFrames_ * 1e9 / (config_.rate * (1.0 + config_.driftPpm * 1e-6));
+        phase_ = Phase::Setup;
+        rearm();
+        return 0;
+    }
+
+    int swParams(struct snd_pcm_sw_params* params) {
+        availMin_ = params->avail_min ? params->avail_min : periodFrames_;
+        stopThreshold_ = params->stop_threshold ? params->stop_threshold : bufferFrames_;
+        params->boundary = boundary_;
+        return 0;
+    }
+
+    int syncPtr(struct snd_pcm_sync_ptr* sync) {
+        if (mmap_ && !(sync->flags & SNDRV_PCM_SYNC_PTR_APPL)) {
+            // Frames the caller committed since the last sync.
+            uint64_t committed = sync->c.control.appl_ptr;
+            appl_ += (committed + boundary_ - appl_ % boundary_) % boundary_;
+        }
+        if (!(sync->flags & SNDRV_PCM_SYNC_PTR_AVAIL_MIN) && sync->c.control.avail_min)
+            availMin_ = sync->c.control.avail_min;
+        advance(monotonicNanos());
+        int res = usable();
+        if (res < 0) return res;
+
+        sync->s.status.hw_ptr = hw_ % boundary_;
+        sync->s.status.tstamp = toTimespec(lastUpdateNanos_);
+        sync->s.status.audio_tstamp = sync->s.status.tstamp;
+        sync->c.control.appl_ptr = appl_ % boundary_;
+        sync->c.control.avail_min = availMin_;
+        rearm();
+        return 0;
+    }
+
+    int read(struct snd_xferi* xfer) {
+        advance(monotonicNanos());
+        int res = usable();
+        if (res < 0) return res;
+        if (phase_ == Phase::Prepared) {
+            // start_threshold is 1 for capture: the first read starts it.
+            start();
+            plugin_.state = kPlugStateRunning;
+        }
+
+        uint64_t frames = std::min<uint64_t>(xfer->frames, bufferFrames_);
+        while (avail() < frames) {
+            if (nonblock_) {
+                if (avail() == 0) return fail(EAGAIN);
+                frames = avail();
+                break;
+            }
+            struct timespec until = toTimespec(wakeTime(appl_ + frames));
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, nullptr);
+            advance(monotonicNanos());
+            res = usable();
+            if (res < 0) return res;
+        }
+
+        uint8_t* dst = static_cast<uint8_t*>(xfer->buf);
+        size_t offset = appl_ % bufferFrames_;
+        size_t first = std::min<size_t>(frames, bufferFrames_ - offset);
+        memcpy(dst, buffer_.data() + offset * frameBytes_, first * frameBytes_);
+        memcpy(dst + first * frameBytes_, buffer_.data(), (frames - first) * frameBytes_);
+        appl_ += frames;
+        xfer->result = static_cast<snd_pcm_sframes_t>(frames);
+        rearm();
+        return 0;
+    }
+
+    int prepare() {
+        if (disconnected_) return fail(ENODEV);
+        xrun_ = false;
+        appl_ = hw_;
+        pending_.clear();
+        phase_ = Phase::Prepared;
+        rearm();
+        return 0;
+    }
+
+    int start() {
+        if (disconnected_) return fail(ENODEV);
+        int64_t now = monotonicNanos();
+        // The host clock restarts with the stream; the schedule stays a
+        // function of the seed and the number of starts.
+        startNanos_ = now;
+        lastUpdateNanos_ = now;
+        lastDueNanos_ = now;
+        nextPacket_ = 0;
+        pending_.clear();
+        stallEndNanos_ = 0;
+        nextStallNanos_ = (config_.stallIntervalSec > 0 && config_.stallMs > 0)
+                              ? now + stallGap()
+                              : INT64_MAX;
+        if (disconnectNanos_ == 0 && config_.disconnectAfterSec > 0)
+            disconnectNanos_ = now + static_cast<int64_t>(config_.disconnectAfterSec * 1e9);
+        gCounters.starts++;
+        phase_ = Phase::Running;
+        rearm();
+        return 0;
+    }
+
+    int drop() {
+        xrun_ = false;
+        pending_.clear();
+        phase_ = Phase::Setup;
+        rearm();
+        return 0;
+    }
+
+    int ioctl(unsigned int cmd, void* arg) {
+        switch (cmd) {
+            case SNDRV_PCM_IOCTL_HWSYNC:
+            case SNDRV_PCM_IOCTL_DELAY: {
+                advance(monotonicNanos());
+                int res = usable();
+                if (res < 0) return res;
+                if (cmd == SNDRV_PCM_IOCTL_DELAY)
+                    *static_cast<snd_pcm_sframes_t*>(arg) = static_cast<snd_pcm_sframes_t>(avail());
+                rearm();
+                return 0;
+            }
+            default:
+                return fail(ENOTTY);
+        }
+    }
+
+    // Only the data area maps; status and control go through sync_ptr.
+    void* map(size_t length, off_t offset) {
+        if (!mmap_ || offset != 0 || length > buffer_.size()) {
+            errno = ENXIO;
+            return MAP_FAILED;
+        }
+        return buffer_.data();
+    }
+
+    int poll(struct pollfd* fds, nfds_t count, int timeout) {
+        advance(monotonicNanos());
+        rearm();
+        return ::poll(fds, count, timeout);
+    }
+
+private:
+    enum class Phase { Setup, Prepared, Running };
+
+    struct Packet {
+        int64_t dueNanos;
+        bool lost;
+    };
+
+    static unsigned int interval(const struct snd_pcm_hw_params* params, int param) {
+        return params->intervals[param - SNDRV_PCM_HW_PARAM_FIRST_INTERVAL].min;
+    }
+
+    uint64_t avail() const { return hw_ - appl_; }
+
+    int usable() const {
+        if (disconnected_) return fail(ENODEV);
+        if (xrun_) return fail(EPIPE);
+        return 0;
+    }
+
+    // Uniform in [0, 1), identical for a given seed on every toolchain.
+    double uniform() { return (rng_() >> 8) * (1.0 / 16777216.0); }
+
+    int64_t stallGap() {
+        return static_cast<int64_t>(config_.stallIntervalSec * 1e9 * (0.5 + uniform()));
+    }
+
+    void scheduleNextPacket() {
+        int64_t nominal =
+            startNanos_ + static_cast<int64_t>(llround(nextPacket_ * packetNanos_));
+        nextPacket_++;
+        while (nominal >= nextStallNanos_) {
+            stallStartNanos_ = nextStallNanos_;
+            stallEndNanos_ = stallStartNanos_ + static_cast<int64_t>(config_.stallMs * 1e6);
+            nextStallNanos_ = stallEndNanos_ + stallGap();
+        }
+        bool lost = nominal >= stallStartNanos_ && nominal < stallEndNanos_;
+        int64_t due = nominal;
+        if (config_.jitterMs > 0)
+            due += static_cast<int64_t>(uniform() * config_.jitterMs * 1e6);
+        due = std::max(due, lastDueNanos_);
+        lastDueNanos_ = due;
+        pending_.push_back({due, lost});
+    }
+
+    const Packet& packetAt(size_t index) {
+        while (pending_.size() <= index) scheduleNextPacket();
+        return pending_[index];
+    }
+
+    // Deliver every packet due by `now`.
+    void advance(int64_t now) {
+        if (disconnected_) return;
+        if (disconnectNanos_ != 0 && now >= disconnectNanos_) {
+            disconnect();
+            return;
+        }
+        if (phase_ != Phase::Running || xrun_) return;
+
+        int64_t delivered = 0;
+        int64_t lost = 0;
+        while (packetAt(0).dueNanos <= now) {
+            Packet packet = pending_.front();
+            pending_.pop_front();
+            if (packet.lost) {
+                if (!stalled_) gCounters.stalls++;
+                stalled_ = true;
+                toneFrame_ += packetFrames_;
+                lost += packetFrames_;
+                continue;
+            }
+            stalled_ = false;
+            deliver(packetFrames_);
+            delivered += packetFrames_;
+            lastUpdateNanos_ = packet.dueNanos;
+            if (avail() >= stopThreshold_) {
+                xrun_ = true;
+                gCounters.xruns++;
+                break;
+            }
+        }
+        gCounters.framesDelivered += delivered;
+        gCounters.framesLost += lost;
+    }
+
+    // Writes over whatever the reader left behind, like the DMA would.
+    void deliver(unsigned int frames) {
+        size_t sample = sampleBytes(format_);
+        for (unsigned int i = 0; i < frames; ++i) {
+            double value = kToneAmplitude *
+                           sin(2.0 * M_PI * kToneHz * static_cast<double>(toneFrame_++) /
+                               config_.rate);
+            uint8_t* frame = buffer_.data() + ((hw_ + i) % bufferFrames_) * frameBytes_;
+            for (unsigned int ch = 0; ch < channels_; ++ch)
+                writeSample(frame + ch * sample, format_, value);
+        }
+        hw_ += frames;
+    }
+
+    // When hw_ reaches `position`, or the disconnect if that comes first.
+    int64_t wakeTime(uint64_t position) {
+        int64_t due = 0;
+        uint64_t hw = hw_;
+        for (size_t i = 0; hw < position; ++i) {
+            const Packet& packet = packetAt(i);
+            if (packet.lost) continue;
+            hw += packetFrames_;
+            due = packet.dueNanos;
+        }
+        if (disconnectNanos_ != 0) due = std::min(due, disconnectNanos_);
+        return due;
+    }
+
+    // Make the poll fd readable exactly when the kernel driver would wake a
+    // poller: an error state, a stream that is not set up for capture yet,
+    // or avail_min frames captured.
+    void rearm() {
+        if (disconnected_) return;
+        int64_t when = 0;  // Disarmed
+        if (xrun_ || phase_ == Phase::Setup) {
+            when = 1;
+        } else if (phase_ == Phase::Running) {
+            when = avail() >= availMin_ ? 1 : std::max<int64_t>(1, wakeTime(appl_ + availMin_));
+        }
+        struct itimerspec spec;
+        memset(&spec, 0, sizeof(spec));
+        spec.it_value = toTimespec(when);
+        timerfd_settime(pollFd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+
+    // An unbound gadget reports POLLERR. A pipe whose reader is gone does
+    // exactly that, and dup2() swaps it in under the fd the caller polls.
+    void disconnect() {
+        disconnected_ = true;
+        gCounters.disconnected = true;
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) == 0) {
+            close(fds[0]);
+            dup2(fds[1], pollFd_);
+            close(fds[1]);
+        }
+    }
+
+    VirtualGadgetConfig config_;
+    std::mt19937 rng_;
+    bool mmap_;
+    bool nonblock_;
+    int pollFd_ = -1;
+
+    struct pcm_plugin plugin_ {};
+    struct pcm_plugin_hw_constraints constraints_ {};
+
+    snd_pcm_format_t format_ = SNDRV_PCM_FORMAT_S16_LE;
+    unsigned int channels_ = 0;
+    size_t frameBytes_ = 0;
+    uint64_t periodFrames_ = 0;
+    uint64_t bufferFrames_ = 0;
+    uint64_t availMin_ = 0;
+    uint64_t stopThreshold_ = 0;
+    uint64_t boundary_ = 1;
+    std::vector<uint8_t> buffer_;
+
+    Phase phase_ = Phase::Setup;
+    bool xrun_ = false;
+    bool disconnected_ = false;
+    bool stalled_ = false;
+    uint64_t hw_ = 0;
+    uint64_t appl_ = 0;
+    uint64_t toneFrame_ = 0;  // Host position, lost frames included
+
+    unsigned int packetFrames_ = 48;
+    double packetNanos_ = 1e6;
+    uint64_t nextPacket_ = 0;
+    std::deque<Packet> pending_;
+    int64_t startNanos_ = 0;
+    int64_t lastUpdateNanos_ = 0;
+    int64_t lastDueNanos_ = 0;
+    int64_t stallStartNanos_ = 0;
+    int64_t stallEndNanos_ = 0;
+    int64_t nextStallNanos_ = INT64_MAX;
+    int64_t disconnectNanos_ = 0;
+};
+
+VirtualGadgetStream* streamOf(struct pcm_plugin* plugin) {
+    return static_cast<VirtualGadgetStream*>(plugin->priv);
+}
+
+// --- PCM plugin ops ---
+
+int pluginOpen(struct pcm_plugin** plugin, unsigned int card, unsigned int device,
+               unsigned int flags) {
+    if (card != kVirtualGadgetCard || device != kVirtualGadgetDevice || !(flags & PCM_IN))
+        return fail(ENODEV);
+    VirtualGadgetStream* stream = new (std::nothrow) VirtualGadgetStream(currentConfig(), flags);
+    if (!stream || !stream->valid()) {
+        int err = stream ? errno : ENOMEM;
+        delete stream;
+        return fail(err);
+    }
+    *plugin = stream->plugin();
+    return 0;
+}
+
+int pluginClose(struct pcm_plugin* plugin) {
+    delete streamOf(plugin);
+    return 0;
+}
+
+int pluginHwParams(struct pcm_plugin* plugin, struct snd_pcm_hw_params* params) {
+    return streamOf(plugin)->hwParams(params);
+}
+
+int pluginSwParams(struct pcm_plugin* plugin, struct snd_pcm_sw_params* params) {
+    return streamOf(plugin)->swParams(params);
+}
+
+int pluginSyncPtr(struct pcm_plugin* plugin, struct snd_pcm_sync_ptr* sync) {
+    return streamOf(plugin)->syncPtr(sync);
+}
+
+int pluginWrite(struct pcm_plugin*, struct snd_xferi*) {
+    return fail(EINVAL);  // Capture only
+}
+
+int pluginRead(struct pcm_plugin* plugin, struct snd_xferi* xfer) {
+    return streamOf(plugin)->read(xfer);
+}
+
+// Positions are always CLOCK_MONOTONIC.
+int pluginTtstamp(struct pcm_plugin*, int*) {
+    return 0;
+}
+
+int pluginPrepare(struct pcm_plugin* plugin) {
+    return streamOf(plugin)->prepare();
+}
+
+int pluginStart(struct pcm_plugin* plugin) {
+    return streamOf(plugin)->start();
+}
+
+int pluginDrain(struct pcm_plugin*) {
+    return 0;
+}
+
+int pluginDrop(struct pcm_plugin* plugin) {
+    return streamOf(plugin)->drop();
+}
+
+int pluginIoctl(struct pcm_plugin* plugin, int cmd, void* arg) {
+    return streamOf(plugin)->ioctl(static_cast<unsigned int>(cmd), arg);
+}
+
+void* pluginMmap(struct pcm_plugin* plugin, void*, size_t length, int, int, off_t offset) {
+    return streamOf(plugin)->map(length, offset);
+}
+
+// The data area belongs to the stream and goes away with it.
+int pluginMunmap(struct pcm_plugin*, void*, size_t) {
+    return 0;
+}
+
+int pluginPoll(struct pcm_plugin* plugin, struct pollfd* fds, nfds_t count, int timeout) {
+    return streamOf(plugin)->poll(fds, count, timeout);
+}
+
+// --- Sound card parser ops ---
+// One card with one capture PCM, served by this same library.
+
+struct DeviceNode {
+    int type;
+    int capture;
+    int playback;
+    const char* name;
+};
+
+int gCardNode;
+DeviceNode gPcmNode = {kNodeTypePlugin, 1, 0, "Virtual UAC Gadget"};
+
+void* parserOpenCard(unsigned int card) {
+    return card == kVirtualGadgetCard ? &gCardNode : nullptr;
+}
+
+void parserCloseCard(void*) {}
+
+int parserGetInt(void* node, const char* prop, int* val) {
+    const DeviceNode* dev = static_cast<const DeviceNode*>(node);
+    if (!dev || !prop || !val) return -EINVAL;
+    if (!strcmp(prop, "type")) {
+        *val = dev->type;
+    } else if (!strcmp(prop, "capture")) {
+        *val = dev->capture;
+    } else if (!strcmp(prop, "playback")) {
+        *val = dev->playback;
+    } else if (!strcmp(prop, "id")) {
+        *val = static_cast<int>(kVirtualGadgetDevice);
+    } else {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+int parserGetStr(void* node, const char* prop, char** val) {
+    const DeviceNode* dev = static_cast<const DeviceNode*>(node);
+    if (!dev || !prop || !val) return -EINVAL;
+    if (!strcmp(prop, "so-name")) {
+        *val = const_cast<char*>(kLibraryName);
+    } else if (!strcmp(prop, "name")) {
+        *val = const_cast<char*>(dev->name);
+    } else {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+// No mixer: the host activity monitor falls back to its timeouts.
+void* parserGetMixer(void*) {
+    return nullptr;
+}
+
+void* parserGetPcm(void* card, unsigned int id) {
+    return (card && id == kVirtualGadgetDevice) ? &gPcmNode : nullptr;
+}
+
+}  // namespace
+
+// Looked up by name with dlsym() from pcm_plugin.c and snd_card_plugin.c.
+extern "C" {
+
+__attribute__((visibility("default"))) struct pcm_plugin_ops pcm_plugin_ops = {
+    pluginOpen,    pluginClose,   pluginHwParams, pluginSwParams, pluginSyncPtr, pluginWrite,
+    pluginRead,    pluginTtstamp, pluginPrepare,  pluginStart,    pluginDrain,   pluginDrop,
+    pluginIoctl,   pluginMmap,    pluginMunmap,   pluginPoll,
+};
+
+__attribute__((visibility("default"))) struct snd_node_ops snd_card_ops = {
+    parserOpenCard, parserCloseCard, parserGetInt, parserGetStr, parserGetMixer, parserGetPcm, {},
+};
+
+}  // extern "C"
+
+void virtualGadgetConfigure(const VirtualGadgetConfig& config) {
+    std::lock_guard<std::mutex> lock(gConfigMutex);
+    gConfig = config;
+    gConfigured = true;
+    gCounters.reset();
+}
+
+VirtualGadgetConfig virtualGadgetConfig() {
+    return currentConfig();
+}
+
+VirtualGadgetCounters virtualGadgetCounters() {
+    VirtualGadgetCounters counters;
+    counters.framesDelivered = gCounters.framesDelivered.load();
+    counters.framesLost = gCounters.framesLost.load();
+    counters.stalls = gCounters.stalls.load();
+    counters.xruns = gCounters.xruns.load();
+    counters.starts = gCounters.starts.load();
+    counters.disconnected = gCounters.disconnected.load();
+    return counters;
+}
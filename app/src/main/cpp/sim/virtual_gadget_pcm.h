@@ -0,0 +1,59 @@
+#ifndef VIRTUAL_GADGET_PCM_H
+#define VIRTUAL_GADGET_PCM_H
+
+#include <cstdint>
+
+// --- Virtual UAC Gadget ---
+// A capture PCM that behaves like the gadget's u_audio device, for running
+// the bridge on a Linux host without USB hardware. Host builds compile
+// tinyalsa with TINYALSA_USES_PLUGINS: when pcm_open() finds no
+// /dev/snd node it asks libsndcardparser.so for the card, and this library
+// is both that parser and the PCM plugin it names. captureLoop() therefore
+// opens it exactly like the real card, mmap or read access alike.
+//
+// The "host" delivers 1 ms packets on a schedule derived only from the
+// config and the seed, so a run with the same settings sees the same drift,
+// jitter, stalls and disconnect. Packets land in the PCM buffer when their
+// time comes on CLOCK_MONOTONIC, and pcm_get_poll_fd() is a timerfd that
+// turns readable when a period is available, so the capture thread sleeps
+// and wakes as it would on the device.
+
+constexpr unsigned int kVirtualGadgetCard = 100;
+constexpr unsigned int kVirtualGadgetDevice = 0;
+
+struct VirtualGadgetConfig {
+    // The only rate the PCM accepts, like a configfs c_srate.
+    unsigned int rate = 48000;
+    // Host clock error against CLOCK_MONOTONIC; positive delivers faster.
+    double driftPpm = 0.0;
+    // Each packet arrives up to this much late (uniform), never reordered.
+    double jitterMs = 0.0;
+    // Mean time between stalls, 0 for none. Packets due during a stall are
+    // lost, as when the host stops sending.
+    double stallIntervalSec = 0.0;
+    double stallMs = 0.0;
+    // Time after the first start at which the gadget unbinds, 0 for never.
+    // Polls then report POLLERR and every call fails with ENODEV.
+    double disconnectAfterSec = 0.0;
+    uint32_t seed = 1;
+};
+
+// What the virtual host has done since the last virtualGadgetConfigure().
+struct VirtualGadgetCounters {
+    int64_t framesDelivered = 0;
+    int64_t framesLost = 0;  // Dropped by stalls
+    int stalls = 0;
+    int xruns = 0;
+    int starts = 0;  // Including restarts after an xrun
+    bool disconnected = false;
+};
+
+// Applies to PCMs opened afterwards and resets the counters. Until it is
+// called, the config comes from USBAUDIO_VGADGET_{RATE, DRIFT_PPM,
+// JITTER_MS, STALL_INTERVAL_S, STALL_MS, DISCONNECT_S, SEED} so unmodified
+// binaries can be pointed at the virtual card too.
+void virtualGadgetConfigure(const VirtualGadgetConfig& config);
+VirtualGadgetConfig virtualGadgetConfig();
+VirtualGadgetCounters virtualGadgetCounters();
+
+#endif  // VIRTUAL_GADGET_PCM_H
@@ -186,6 +186,8 @@ struct pcm_plugin {
     void* priv;
     /* Tracks the plugin state */
     unsigned int state;
+    /* Optional fd returned by pcm_get_poll_fd(), 0 if the plugin has none */
+    int poll_fd;
 };
 
 typedef void (*mixer_event_callback)(struct mixer_plugin*);
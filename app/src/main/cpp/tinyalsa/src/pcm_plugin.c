@@ -370,6 +370,12 @@ static int pcm_plug_interval_refine(struct snd_pcm_hw_params *p,
         /* Set the changed mask */
         if (changed)
             p->cmask |= (1 << (idx + SNDRV_PCM_HW_PARAM_FIRST_INTERVAL));
+
+        /* the request lies outside the plugin's constraints */
+        if (ri->min > ri->max) {
+            errno = EINVAL;
+            return -EINVAL;
+        }
     }
 
     return 0;
@@ -774,7 +780,8 @@ static int pcm_plug_open(unsigned int card, unsigned int device,
 
     plug_data->plugin->state = PCM_PLUG_STATE_OPEN;
 
-    return 0;
+    /* becomes pcm->fd, so pollers can wait on the plugin directly */
+    return plug_data->plugin->poll_fd;
 
 err_open:
 err_dlsym:
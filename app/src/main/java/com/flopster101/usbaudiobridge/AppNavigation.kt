@@ -53,6 +53,10 @@ fun AppNavigation(
     onToggleSpeakerMute: () -> Unit,
     onToggleMicMute: () -> Unit,
     onMuteOnMediaButtonChange: (Boolean) -> Unit,
+    onRateAdaptationChange: (Boolean) -> Unit,
+    onCpuPinningChange: (Boolean) -> Unit,
+    onSingleThreadBridgeChange: (Boolean) -> Unit,
+    onAdaptiveLatencyChange: (Boolean) -> Unit,
     onResetSettings: () -> Unit,
     onToggleLogs: () -> Unit
 ) {
@@ -137,6 +141,10 @@ fun AppNavigation(
                     onScreensaverDvdSpeedChange = onScreensaverDvdSpeedChange,
                     onScreensaverFullscreenChange = onScreensaverFullscreenChange,
                     onMuteOnMediaButtonChange = onMuteOnMediaButtonChange,
+                    onRateAdaptationChange = onRateAdaptationChange,
+                    onCpuPinningChange = onCpuPinningChange,
+                    onSingleThreadBridgeChange = onSingleThreadBridgeChange,
+                    onAdaptiveLatencyChange = onAdaptiveLatencyChange,
                     onResetSettings = onResetSettings
                 )
             }
@@ -30,7 +30,6 @@ class AudioService : Service() {
         const val TAG = "AudioService"
         const val ACTION_LOG = "com.flopster101.usbaudiobridge.LOG"
         const val ACTION_STATE_CHANGED = "com.flopster101.usbaudiobridge.STATE_CHANGED"
-        const val ACTION_STATS_UPDATE = "com.flopster101.usbaudiobridge.STATS_UPDATE"
         const val ACTION_GADGET_RESULT = "com.flopster101.usbaudiobridge.GADGET_RESULT"
         const val ACTION_GADGET_STATUS = "com.flopster101.usbaudiobridge.GADGET_STATUS"
         const val ACTION_OUTPUT_DISCONNECT = "com.flopster101.usbaudiobridge.OUTPUT_DISCONNECT"
@@ -41,9 +40,6 @@ class AudioService : Service() {
         const val EXTRA_IS_MUTED = "isMuted"
         const val EXTRA_STATE_LABEL = "stateLabel"
         const val EXTRA_STATE_COLOR = "stateColor"
-        const val EXTRA_RATE = "rate"
-        const val EXTRA_PERIOD = "period"
-        const val EXTRA_BUFFER = "buffer"
         const val EXTRA_ACTIVE_DIRECTIONS = "activeDirections"
 
         // State Codes matching Native
@@ -117,6 +113,15 @@ class AudioService : Service() {
         }
     }
 
+    // Called from C++ JNI (latency accounting)
+    fun getAudioTrackHeadPosition(): Int {
+        return try {
+            audioTrack?.playbackHeadPosition ?: 0
+        } catch (e: Exception) {
+            0
+        }
+    }
+
     // Called from C++ JNI
     fun stopAudioTrack() {
         try {
@@ -163,6 +168,16 @@ class AudioService : Service() {
     external fun stopAudioBridge()
     external fun setNativeSpeakerMute(muted: Boolean)
     external fun setNativeMicMute(muted: Boolean)
+    external fun setNativeRateAdaptation(enabled: Boolean)
+    external fun setNativeCpuPinning(enabled: Boolean)
+    external fun setNativeSingleThread(enabled: Boolean)
+    external fun setNativeCaptureLayoutHint(periodFrames: Int, periodCount: Int)
+    external fun setNativeAdaptiveLatency(enabled: Boolean)
+    external fun setNativeLatencyTargetHint(targetFrames: Int)
+    private external fun getNativeStatsBuffer(): java.nio.ByteBuffer
+
+    // Shared with the native audio threads; poll at whatever rate the UI needs.
+    val nativeStats: NativeStatsReader by lazy { NativeStatsReader(getNativeStatsBuffer()) }
 
     // Called from C++ JNI
     fun onNativeLog(msg: String) {
@@ -204,31 +219,33 @@ class AudioService : Service() {
         }
     }
 
-    // Called from C++ JNI
-    fun onNativeThreadStart(tid: Int) {
-        serviceScope.launch(Dispatchers.IO) {
-            // Apply SCHED_FIFO (Real-Time) priority
-            // -f : FIFO
-            // -p 50 : Priority 50 (Range 1-99)
-            val cmd = "chrt -f -p 50 $tid"
-            UsbGadgetManager.runRootCommand(cmd) { /* ignore output */ }
-            Log.d(TAG, "Promoted thread $tid to SCHED_FIFO")
-            broadcastLog("[App] Thread $tid promoted to Real-Time (FIFO)")
-        }
-    }
+    // Threads whose own sched_setscheduler() was refused, waiting for the root helper
+    private val pendingRtThreads = mutableListOf<Int>()
+    private var rtPromotionJob: Job? = null
 
-    // Called from C++ JNI
-    fun onNativeStats(rate: Int, period: Int, buffer: Int) {
-        val intent = Intent(ACTION_STATS_UPDATE).apply {
-            putExtra(EXTRA_RATE, rate)
-            putExtra(EXTRA_PERIOD, period)
-            putExtra(EXTRA_BUFFER, buffer)
-        }
-        intent.setPackage(packageName)
-        sendBroadcast(intent)
-        // Ensure state reflects streaming (in case we missed a transition or to refresh)
-        if (lastNativeState != STATE_STREAMING) {
-            onNativeState(STATE_STREAMING)
+    // Called from C++ JNI, only when native SCHED_FIFO failed
+    fun onNativeThreadStart(tid: Int) {
+        synchronized(pendingRtThreads) {
+            pendingRtThreads.add(tid)
+            if (rtPromotionJob != null) return
+            rtPromotionJob = serviceScope.launch(Dispatchers.IO) {
+                // Audio threads start together; one su per batch instead of per thread
+                delay(50)
+                while (true) {
+                    val tids = synchronized(pendingRtThreads) {
+                        if (pendingRtThreads.isEmpty()) {
+                            rtPromotionJob = null
+                            return@launch
+                        }
+                        pendingRtThreads.toList().also { pendingRtThreads.clear() }
+                    }
+                    // -f : FIFO, -p 50 : Priority 50 (Range 1-99), same as the native request
+                    val commands = tids.map { "chrt -f -p 50 $it" }
+                    UsbGadgetManager.runRootCommands(commands) { /* ignore output */ }
+                    Log.d(TAG, "Promoted threads $tids to SCHED_FIFO")
+                    broadcastLog("[App] Threads ${tids.joinToString()} promoted to Real-Time (FIFO) via root")
+                }
+            }
         }
     }
 
@@ -250,6 +267,33 @@ class AudioService : Service() {
         updateUiState()
     }
 
+    // Called from C++ JNI once a capture layout other than the hint has worked
+    fun onCaptureLayout(periodFrames: Int, periodCount: Int) {
+        val key = captureLayoutKey ?: return
+        settingsRepo.saveCaptureLayout(key, periodFrames, periodCount)
+        Log.d(TAG, "Cached capture layout $periodFrames x $periodCount for $key")
+    }
+
+    // Called from C++ JNI when adaptive latency moved its target fill
+    fun onLatencyTarget(targetFrames: Int) {
+        val key = latencyTargetKey ?: return
+        settingsRepo.saveLatencyTarget(key, targetFrames)
+        Log.d(TAG, "Cached latency target $targetFrames frames for $key")
+    }
+
+    // Called from C++ JNI when the host switched the gadget to another sample rate
+    fun onHostRateChange(rate: Int) {
+        if (!isBridgeRunning || rate == lastSampleRate) return
+        broadcastLog("[App] Host switched to $rate Hz - restarting stream...")
+        serviceScope.launch {
+            stopAudioBridge()
+            isBridgeRunning = false
+            if (lastBufferSize > 0) {
+                startBridge(lastBufferSize, lastPeriodSize, lastEngineType, rate, lastActiveDirections, lastMicSource)
+            }
+        }
+    }
+
     // Called from C++ JNI when audio output is disconnected (e.g., headphones unplugged)
     fun onOutputDisconnect() {
         broadcastLog("[App] Audio output disconnected (native callback)")
@@ -309,6 +353,11 @@ class AudioService : Service() {
     private var lastActiveDirections = 1
     private var lastMicSource = 6
 
+    // Capture layout cache key of the running bridge (card, device, rate, buffer, period request)
+    @Volatile private var captureLayoutKey: String? = null
+    // Adaptive latency target key of the running bridge (output route, engine, rate)
+    @Volatile private var latencyTargetKey: String? = null
+
     private val usbReceiver = object : BroadcastReceiver() {
         override fun onReceive(context: Context?, intent: Intent?) {
             updateUiState()
@@ -592,6 +641,20 @@ class AudioService : Service() {
                 startForeground(1, createNotification("Active", true))
             }
 
+            setNativeRateAdaptation(settingsRepo.getRateAdaptation())
+            setNativeCpuPinning(settingsRepo.getCpuPinning())
+            setNativeSingleThread(settingsRepo.getSingleThreadBridge())
+            // Same gadget and request as a previous start: open its layout first
+            val layoutKey = "${cardId}_0_${sampleRate}_${bufferSize}_$periodSize"
+            captureLayoutKey = layoutKey
+            val cachedLayout = settingsRepo.getCaptureLayout(layoutKey)
+            setNativeCaptureLayoutHint(cachedLayout?.first ?: 0, cachedLayout?.second ?: 0)
+            // Each phone route and engine settles on its own target: start from the last one
+            val adaptiveLatency = settingsRepo.getAdaptiveLatency()
+            val targetKey = "${PlaybackDeviceHelper.getCurrentPlaybackDevice(this@AudioService).name}_${engineType}_$sampleRate"
+            latencyTargetKey = if (adaptiveLatency) targetKey else null
+            setNativeAdaptiveLatency(adaptiveLatency)
+            setNativeLatencyTargetHint(if (adaptiveLatency) settingsRepo.getLatencyTarget(targetKey) else 0)
             startAudioBridge(cardId, 0, bufferSize, periodSize, engineType, sampleRate, activeDirections, micSource)
 
             isBridgeRunning = true
@@ -242,6 +242,20 @@ fun HomeScreen(
                         StatusRow("Period size", state.periodSize)
                         Spacer(Modifier.height(8.dp))
                         StatusRow("Current buffer", state.currentBuffer)
+                        Spacer(Modifier.height(8.dp))
+                        StatusRow("Clock drift", state.clockDrift)
+                        Spacer(Modifier.height(8.dp))
+                        StatusRow("Latency", state.latency)
+                        Spacer(Modifier.height(8.dp))
+                        StatusRow("Ring fill", state.ringFill)
+                        Spacer(Modifier.height(8.dp))
+                        StatusRow("Dropouts", state.dropouts)
+                        Spacer(Modifier.height(8.dp))
+                        StatusRow("Chunk switches", state.chunkSwitches)
+                        Spacer(Modifier.height(8.dp))
+                        StatusRow("CPU time", state.cpuTime)
+                        Spacer(Modifier.height(8.dp))
+                        StatusRow("Scheduling", state.scheduling)
                     }
                 }
             }
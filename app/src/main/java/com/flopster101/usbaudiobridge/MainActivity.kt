@@ -132,26 +132,38 @@ class MainActivity : ComponentActivity() {
                 uiState = uiState.copy(
                     sampleRate = "--",
                     periodSize = "--",
-                    currentBuffer = "--"
+                    currentBuffer = "--",
+                    clockDrift = "--",
+                    latency = "--",
+                    ringFill = "--",
+                    dropouts = "--",
+                    chunkSwitches = "--",
+                    cpuTime = "--",
+                    scheduling = "--"
                 )
             }
         }
     }
 
-    private val statsReceiver = object : BroadcastReceiver() {
-        override fun onReceive(context: Context?, intent: Intent?) {
-            if (intent == null) return
-            val rate = intent.getIntExtra(AudioService.EXTRA_RATE, 0)
-            val period = intent.getIntExtra(AudioService.EXTRA_PERIOD, 0)
-            val buffer = intent.getIntExtra(AudioService.EXTRA_BUFFER, 0)
-
-            // State label is handled by stateReceiver now via Service broadcast
-            uiState = uiState.copy(
-                sampleRate = "$rate Hz",
-                periodSize = "$period frames",
-                currentBuffer = "$buffer frames"
-            )
-        }
+    private fun updateNativeStats() {
+        val stats = audioService?.nativeStats?.read() ?: return
+        if (stats.sampleRate == 0) return // Not streaming yet
+
+        uiState = uiState.copy(
+            sampleRate = "${stats.sampleRate} Hz",
+            periodSize = "${stats.periodFrames} frames",
+            currentBuffer = "${stats.bufferFrames} frames",
+            clockDrift = if (stats.driftPpm.isNaN()) "--" else String.format(Locale.US, "%+.1f ppm", stats.driftPpm),
+            latency = if (stats.latencyAvgMs <= 0f) "--" else String.format(
+                Locale.US, "%.1f ms (%.1f-%.1f)", stats.latencyAvgMs, stats.latencyMinMs, stats.latencyMaxMs
+            ),
+            ringFill = "${stats.ringFill} frames (${stats.ringFillMin}-${stats.ringFillMax})",
+            dropouts = "${stats.underruns} under, ${stats.overruns} over, ${stats.xruns} xrun",
+            chunkSwitches = "${stats.modeSwitches}",
+            cpuTime = String.format(Locale.US, "%.1f s out, %.1f s in", stats.outputCpuMs / 1000.0, stats.captureCpuMs / 1000.0),
+            scheduling = "in ${NativeStats.describeSched(stats.threadSched[NativeStats.ROLE_CAPTURE])} (CPU ${stats.threadCpu[NativeStats.ROLE_CAPTURE]}), " +
+                "out ${NativeStats.describeSched(stats.threadSched[NativeStats.ROLE_OUTPUT])} (CPU ${stats.threadCpu[NativeStats.ROLE_OUTPUT]})"
+        )
     }
 
     private fun isOldKernelAffected(): Boolean {
@@ -288,7 +300,11 @@ class MainActivity : ComponentActivity() {
             screensaverDvdMode = settingsRepo.getScreensaverDvdMode(),
             screensaverDvdSpeed = settingsRepo.getScreensaverDvdSpeed(),
             screensaverFullscreen = settingsRepo.getScreensaverFullscreen(),
-            muteOnMediaButton = settingsRepo.getMuteOnMediaButton()
+            muteOnMediaButton = settingsRepo.getMuteOnMediaButton(),
+            rateAdaptation = settingsRepo.getRateAdaptation(),
+            cpuPinning = settingsRepo.getCpuPinning(),
+            singleThreadBridge = settingsRepo.getSingleThreadBridge(),
+            adaptiveLatency = settingsRepo.getAdaptiveLatency()
         )
 
         // Reconciliation: If in Simple mode, ensure bufferSize matches the preset
@@ -342,6 +358,15 @@ class MainActivity : ComponentActivity() {
             }
         }
 
+        // Native stats are read from shared memory, so polling costs the
+        // audio threads nothing
+        lifecycleScope.launch {
+            while (true) {
+                kotlinx.coroutines.delay(500)
+                if (uiState.isServiceRunning) updateNativeStats()
+            }
+        }
+
         // Request notification permission for Android 13+
         if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
             if (checkSelfPermission(android.Manifest.permission.POST_NOTIFICATIONS) != PackageManager.PERMISSION_GRANTED) {
@@ -352,7 +377,6 @@ class MainActivity : ComponentActivity() {
         // Register Receivers
         ContextCompat.registerReceiver(this, logReceiver, IntentFilter(AudioService.ACTION_LOG), ContextCompat.RECEIVER_NOT_EXPORTED)
         ContextCompat.registerReceiver(this, stateReceiver, IntentFilter(AudioService.ACTION_STATE_CHANGED), ContextCompat.RECEIVER_NOT_EXPORTED)
-        ContextCompat.registerReceiver(this, statsReceiver, IntentFilter(AudioService.ACTION_STATS_UPDATE), ContextCompat.RECEIVER_NOT_EXPORTED)
         ContextCompat.registerReceiver(this, gadgetResultReceiver, IntentFilter(AudioService.ACTION_GADGET_RESULT), ContextCompat.RECEIVER_NOT_EXPORTED)
         ContextCompat.registerReceiver(this, gadgetStatusReceiver, IntentFilter(AudioService.ACTION_GADGET_STATUS), ContextCompat.RECEIVER_NOT_EXPORTED)
 
@@ -622,6 +646,22 @@ class MainActivity : ComponentActivity() {
                                 uiState = uiState.copy(muteOnMediaButton = it)
                                 settingsRepo.saveMuteOnMediaButton(it)
                             },
+                            onRateAdaptationChange = {
+                                uiState = uiState.copy(rateAdaptation = it)
+                                settingsRepo.saveRateAdaptation(it)
+                            },
+                            onCpuPinningChange = {
+                                uiState = uiState.copy(cpuPinning = it)
+                                settingsRepo.saveCpuPinning(it)
+                            },
+                            onSingleThreadBridgeChange = {
+                                uiState = uiState.copy(singleThreadBridge = it)
+                                settingsRepo.saveSingleThreadBridge(it)
+                            },
+                            onAdaptiveLatencyChange = {
+                                uiState = uiState.copy(adaptiveLatency = it)
+                                settingsRepo.saveAdaptiveLatency(it)
+                            },
                             onResetSettings = {
                                 settingsRepo.resetDefaults()
                                 uiState = uiState.copy(
@@ -653,7 +693,11 @@ class MainActivity : ComponentActivity() {
                                     screensaverDvdMode = settingsRepo.getScreensaverDvdMode(),
                                     screensaverDvdSpeed = settingsRepo.getScreensaverDvdSpeed(),
                                     screensaverFullscreen = settingsRepo.getScreensaverFullscreen(),
-                                    muteOnMediaButton = settingsRepo.getMuteOnMediaButton()
+                                    muteOnMediaButton = settingsRepo.getMuteOnMediaButton(),
+                                    rateAdaptation = settingsRepo.getRateAdaptation(),
+                                    cpuPinning = settingsRepo.getCpuPinning(),
+                                    singleThreadBridge = settingsRepo.getSingleThreadBridge(),
+                                    adaptiveLatency = settingsRepo.getAdaptiveLatency()
                                 )
                             },
                             onToggleLogs = { uiState = uiState.copy(isLogsExpanded = !uiState.isLogsExpanded) }
@@ -706,7 +750,6 @@ class MainActivity : ComponentActivity() {
         super.onDestroy()
         unregisterReceiver(logReceiver)
         unregisterReceiver(stateReceiver)
-        unregisterReceiver(statsReceiver)
         unregisterReceiver(gadgetResultReceiver)
         unregisterReceiver(gadgetStatusReceiver)
         if (uiState.isAppBound) unbindService(connection)
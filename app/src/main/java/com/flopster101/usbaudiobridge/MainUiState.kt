@@ -40,6 +40,10 @@ data class MainUiState(
     val speakerMuted: Boolean = false,
     val micMuted: Boolean = false,
     val muteOnMediaButton: Boolean = true,
+    val rateAdaptation: Boolean = false,
+    val cpuPinning: Boolean = false,
+    val singleThreadBridge: Boolean = false,
+    val adaptiveLatency: Boolean = false,
 
     // Status
     val serviceState: String = "--",
@@ -47,6 +51,13 @@ data class MainUiState(
     val sampleRate: String = "--",
     val periodSize: String = "--",
     val currentBuffer: String = "--",
+    val clockDrift: String = "--",
+    val latency: String = "--",
+    val ringFill: String = "--",
+    val dropouts: String = "--",
+    val chunkSwitches: String = "--",
+    val cpuTime: String = "--",
+    val scheduling: String = "--",
 
     // Gadget Status
     val udcController: String = "--",
@@ -0,0 +1,136 @@
+package com.flopster101.usbaudiobridge
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+// Snapshot of the native stats block (cpp/core/bridge_stats.h)
+data class NativeStats(
+    val sampleRate: Int,
+    val periodFrames: Int,
+    val bufferFrames: Int,
+    val ringCapacity: Int,
+    val ringFill: Int,
+    val ringFillMin: Int,
+    val ringFillMax: Int,
+    val underruns: Int,
+    val modeSwitches: Int,
+    val driftPpm: Float, // NaN while unknown
+    val outputCpuMs: Int,
+    val overruns: Int,
+    val xruns: Int,
+    val captureCpuMs: Int,
+    // Host-to-speaker estimate; min/avg/max over the last window
+    val latencyMs: Float,
+    val latencyMinMs: Float,
+    val latencyAvgMs: Float,
+    val latencyMaxMs: Float,
+    val captureDelayFrames: Int,
+    val engineQueuedFrames: Int, // -1 when the engine cannot tell
+    // Per thread role (capture, output, mic): (policy << 8) | priority and
+    // last CPU, -1 while the thread has not run
+    val threadSched: IntArray,
+    val threadCpu: IntArray
+) {
+    companion object {
+        const val ROLE_CAPTURE = 0
+        const val ROLE_OUTPUT = 1
+        const val ROLE_MIC = 2
+
+        // Linux policy numbers
+        private const val SCHED_OTHER = 0
+        private const val SCHED_FIFO = 1
+        private const val SCHED_RR = 2
+
+        fun describeSched(packed: Int): String {
+            if (packed < 0) return "--"
+            val priority = packed and 0xFF
+            return when (packed shr 8) {
+                SCHED_FIFO -> "FIFO $priority"
+                SCHED_RR -> "RR $priority"
+                SCHED_OTHER -> "normal"
+                else -> "policy ${packed shr 8}"
+            }
+        }
+    }
+}
+
+// Reads the shared stats block without ever calling into native code. Each
+// section is a seqlock: a section is retried while its sequence is odd or
+// changed under the read. Plain ByteBuffer reads carry no ordering
+// guarantee, so the worst case is a snapshot that mixes two consecutive
+// updates - harmless for display.
+class NativeStatsReader(buffer: ByteBuffer) {
+
+    private companion object {
+        const val LAYOUT_VERSION = 3
+        const val MAX_RETRIES = 8
+
+        // Byte offsets, must match BridgeStatsBlock. Each sequence word is
+        // followed by its section's fields in declaration order.
+        const val OFF_VERSION = 0
+        const val OFF_CONFIG_SEQ = 4
+        const val OFF_OUTPUT_SEQ = 24
+        const val OFF_CAPTURE_SEQ = 56
+        const val OFF_LATENCY_SEQ = 72
+        // Unsequenced single values, one per thread role
+        const val OFF_THREAD_SCHED = 100
+        const val OFF_THREAD_CPU = 112
+        const val THREAD_ROLES = 3
+    }
+
+    private val buf = buffer.order(ByteOrder.nativeOrder())
+
+    val isCompatible: Boolean
+        get() = buf.getInt(OFF_VERSION) == LAYOUT_VERSION
+
+    // Null if a section kept changing under the reader or the layout does not match.
+    fun read(): NativeStats? {
+        if (!isCompatible) return null
+
+        var config: IntArray? = null
+        var output: IntArray? = null
+        var capture: IntArray? = null
+        var latency: IntArray? = null
+        for (attempt in 0 until MAX_RETRIES) {
+            if (config == null) config = readSection(OFF_CONFIG_SEQ, 4)
+            if (output == null) output = readSection(OFF_OUTPUT_SEQ, 7)
+            if (capture == null) capture = readSection(OFF_CAPTURE_SEQ, 3)
+            if (latency == null) latency = readSection(OFF_LATENCY_SEQ, 6)
+            if (config != null && output != null && capture != null && latency != null) break
+        }
+        if (config == null || output == null || capture == null || latency == null) return null
+
+        return NativeStats(
+            sampleRate = config[0],
+            periodFrames = config[1],
+            bufferFrames = config[2],
+            ringCapacity = config[3],
+            ringFill = output[0],
+            ringFillMin = output[1],
+            ringFillMax = output[2],
+            underruns = output[3],
+            modeSwitches = output[4],
+            driftPpm = Float.fromBits(output[5]),
+            outputCpuMs = output[6],
+            overruns = capture[0],
+            xruns = capture[1],
+            captureCpuMs = capture[2],
+            latencyMs = Float.fromBits(latency[0]),
+            latencyMinMs = Float.fromBits(latency[1]),
+            latencyAvgMs = Float.fromBits(latency[2]),
+            latencyMaxMs = Float.fromBits(latency[3]),
+            captureDelayFrames = latency[4],
+            engineQueuedFrames = latency[5],
+            threadSched = IntArray(THREAD_ROLES) { buf.getInt(OFF_THREAD_SCHED + it * 4) },
+            threadCpu = IntArray(THREAD_ROLES) { buf.getInt(OFF_THREAD_CPU + it * 4) }
+        )
+    }
+
+    // `count` 32-bit fields following the sequence word, or null on a torn read.
+    private fun readSection(seqOffset: Int, count: Int): IntArray? {
+        val before = buf.getInt(seqOffset)
+        if (before and 1 != 0) return null
+        val fields = IntArray(count) { buf.getInt(seqOffset + 4 + it * 4) }
+        return if (buf.getInt(seqOffset) == before) fields else null
+    }
+}
@@ -37,6 +37,36 @@ class SettingsRepository(context: Context) {
     fun saveMuteOnMediaButton(enabled: Boolean) = prefs.edit().putBoolean("mute_on_media_button", enabled).apply()
     fun getMuteOnMediaButton(): Boolean = prefs.getBoolean("mute_on_media_button", true)
 
+    // If true: resample by a few ppm to hold the ring fill steady instead of drifting into xruns
+    fun saveRateAdaptation(enabled: Boolean) = prefs.edit().putBoolean("rate_adaptation", enabled).apply()
+    fun getRateAdaptation(): Boolean = prefs.getBoolean("rate_adaptation", false)
+
+    // If true: bind capture/output threads to the fastest multi-core CPU cluster
+    fun saveCpuPinning(enabled: Boolean) = prefs.edit().putBoolean("cpu_pinning", enabled).apply()
+    fun getCpuPinning(): Boolean = prefs.getBoolean("cpu_pinning", false)
+
+    // If true: capture and output share one poll-driven thread (push engines only)
+    fun saveSingleThreadBridge(enabled: Boolean) = prefs.edit().putBoolean("single_thread_bridge", enabled).apply()
+    fun getSingleThreadBridge(): Boolean = prefs.getBoolean("single_thread_bridge", false)
+
+    // If true: tune the ring's target fill at runtime, with the buffer size as the upper bound
+    fun saveAdaptiveLatency(enabled: Boolean) = prefs.edit().putBoolean("adaptive_latency", enabled).apply()
+    fun getAdaptiveLatency(): Boolean = prefs.getBoolean("adaptive_latency", false)
+
+    // Last capture period layout the gadget accepted, per bridge request (see AudioService.captureLayoutKey)
+    fun saveCaptureLayout(key: String, periodFrames: Int, periodCount: Int) =
+        prefs.edit().putString("capture_layout_$key", "$periodFrames:$periodCount").apply()
+    fun getCaptureLayout(key: String): Pair<Int, Int>? {
+        val parts = prefs.getString("capture_layout_$key", null)?.split(":") ?: return null
+        val frames = parts.getOrNull(0)?.toIntOrNull() ?: return null
+        val count = parts.getOrNull(1)?.toIntOrNull() ?: return null
+        return Pair(frames, count)
+    }
+
+    // Last target fill adaptive latency settled on, per output route (see AudioService.latencyTargetKey)
+    fun saveLatencyTarget(key: String, frames: Int) = prefs.edit().putInt("latency_target_$key", frames).apply()
+    fun getLatencyTarget(key: String): Int = prefs.getInt("latency_target_$key", 0)
+
     // 1 = Speaker (Host->Phone), 2 = Mic (Phone->Host), 3 = Both
     fun saveActiveDirections(mask: Int) = prefs.edit().putInt("active_directions", mask).apply()
     fun getActiveDirections(): Int = prefs.getInt("active_directions", 1)
@@ -41,6 +41,10 @@ fun SettingsScreen(
     onScreensaverDvdSpeedChange: (Int) -> Unit,
     onScreensaverFullscreenChange: (Boolean) -> Unit,
     onMuteOnMediaButtonChange: (Boolean) -> Unit,
+    onRateAdaptationChange: (Boolean) -> Unit,
+    onCpuPinningChange: (Boolean) -> Unit,
+    onSingleThreadBridgeChange: (Boolean) -> Unit,
+    onAdaptiveLatencyChange: (Boolean) -> Unit,
     onResetSettings: () -> Unit
 ) {
     LazyColumn(
@@ -378,6 +382,11 @@ fun SettingsScreen(
                             onClick = { onEngineTypeChange(0) },
                             label = { Text("AAudio") }
                         )
+                        FilterChip(
+                            selected = state.engineTypeOption == 3,
+                            onClick = { onEngineTypeChange(3) },
+                            label = { Text("AAudio callback") }
+                        )
                         FilterChip(
                             selected = state.engineTypeOption == 1,
                             onClick = { onEngineTypeChange(1) },
@@ -393,6 +402,7 @@ fun SettingsScreen(
                     Spacer(Modifier.height(12.dp))
                     val desc = when(state.engineTypeOption) {
                         0 -> "AAudio: Low latency, high performance. Recommended for Android 8.1+."
+                        3 -> "AAudio callback: AAudio pulls audio directly from the bridge buffer. Lowest output latency, no extra consumer thread."
                         1 -> "OpenSL ES: Native audio standard. Good alternative if AAudio has glitches."
                         2 -> "AudioTrack: Legacy Java-based audio. Highest compatibility, higher latency."
                         else -> ""
@@ -576,7 +586,7 @@ fun SettingsScreen(
         item { Spacer(Modifier.height(2.dp)) }
 
         item {
-            GroupedSettingsCard(position = SettingsGroupPosition.Bottom) {
+            GroupedSettingsCard(position = SettingsGroupPosition.Middle) {
                 Column(modifier = Modifier.padding(16.dp)) {
                     Row(
                         modifier = Modifier.fillMaxWidth(),
@@ -603,6 +613,126 @@ fun SettingsScreen(
                 }
             }
         }
+        item { Spacer(Modifier.height(2.dp)) }
+
+        item {
+            GroupedSettingsCard(position = SettingsGroupPosition.Middle) {
+                Column(modifier = Modifier.padding(16.dp)) {
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        Column(modifier = Modifier.weight(1f)) {
+                            Text(
+                                text = "Clock drift compensation",
+                                style = MaterialTheme.typography.bodyLarge,
+                                color = MaterialTheme.colorScheme.onSurface
+                            )
+                            Text(
+                                text = "Keep the buffer level steady when the host and phone clocks drift apart. Uses the UAC2 feedback pitch control when the kernel provides it, otherwise resamples slightly. Prevents periodic dropouts in long sessions and allows smaller buffers. Applies on next start.",
+                                style = MaterialTheme.typography.bodySmall,
+                                color = MaterialTheme.colorScheme.onSurfaceVariant
+                            )
+                        }
+                        Spacer(Modifier.width(16.dp))
+                        Switch(
+                            checked = state.rateAdaptation,
+                            onCheckedChange = onRateAdaptationChange
+                        )
+                    }
+                }
+            }
+        }
+        item { Spacer(Modifier.height(2.dp)) }
+
+        item {
+            GroupedSettingsCard(position = SettingsGroupPosition.Middle) {
+                Column(modifier = Modifier.padding(16.dp)) {
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        Column(modifier = Modifier.weight(1f)) {
+                            Text(
+                                text = "Pin audio threads to fast cores",
+                                style = MaterialTheme.typography.bodyLarge,
+                                color = MaterialTheme.colorScheme.onSurface
+                            )
+                            Text(
+                                text = "Keep capture and output on the fastest CPU cluster so they are never migrated to a slow core. Can help on big.LITTLE devices with dropouts under load, at some battery cost. Applies on next start.",
+                                style = MaterialTheme.typography.bodySmall,
+                                color = MaterialTheme.colorScheme.onSurfaceVariant
+                            )
+                        }
+                        Spacer(Modifier.width(16.dp))
+                        Switch(
+                            checked = state.cpuPinning,
+                            onCheckedChange = onCpuPinningChange
+                        )
+                    }
+                }
+            }
+        }
+        item { Spacer(Modifier.height(2.dp)) }
+
+        item {
+            GroupedSettingsCard(position = SettingsGroupPosition.Middle) {
+                Column(modifier = Modifier.padding(16.dp)) {
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        Column(modifier = Modifier.weight(1f)) {
+                            Text(
+                                text = "Single-thread bridge",
+                                style = MaterialTheme.typography.bodyLarge,
+                                color = MaterialTheme.colorScheme.onSurface
+                            )
+                            Text(
+                                text = "Capture and output run on one thread driven by the USB device, instead of two threads handing audio over. Fewer context switches for low-latency presets. Not used with the AAudio callback engine. Applies on next start.",
+                                style = MaterialTheme.typography.bodySmall,
+                                color = MaterialTheme.colorScheme.onSurfaceVariant
+                            )
+                        }
+                        Spacer(Modifier.width(16.dp))
+                        Switch(
+                            checked = state.singleThreadBridge,
+                            onCheckedChange = onSingleThreadBridgeChange
+                        )
+                    }
+                }
+            }
+        }
+        item { Spacer(Modifier.height(2.dp)) }
+
+        item {
+            GroupedSettingsCard(position = SettingsGroupPosition.Bottom) {
+                Column(modifier = Modifier.padding(16.dp)) {
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        Column(modifier = Modifier.weight(1f)) {
+                            Text(
+                                text = "Adaptive latency",
+                                style = MaterialTheme.typography.bodyLarge,
+                                color = MaterialTheme.colorScheme.onSurface
+                            )
+                            Text(
+                                text = "Start with a small buffer fill and grow it only when dropouts or timing jitter call for more, shrinking again once playback stays clean. The buffer size becomes the upper limit. The result is remembered per output device and engine. Applies on next start.",
+                                style = MaterialTheme.typography.bodySmall,
+                                color = MaterialTheme.colorScheme.onSurfaceVariant
+                            )
+                        }
+                        Spacer(Modifier.width(16.dp))
+                        Switch(
+                            checked = state.adaptiveLatency,
+                            onCheckedChange = onAdaptiveLatencyChange
+                        )
+                    }
+                }
+            }
+        }
         item { Spacer(Modifier.height(20.dp)) }
 
         // Notification